@@ -0,0 +1,247 @@
+#include "bench.hpp"
+#include "engine.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+// Midgame positions reached by letting a shallow single-threaded search play
+// both sides from the start, so every run benchmarks the same boards.
+static vector<pair<AnyBoard, Disk>> benchPositions()
+{
+    vector<pair<AnyBoard, Disk>> out;
+    AnyBoard board(8);
+    Disk turn = Disk::X;
+    Engine engine(1, 1);
+    SearchLimits limits;
+    limits.seconds = 60;
+    limits.maxDepth = 4;
+
+    for (int ply = 0; ply <= 30; ply++) {
+        if (ply % 10 == 0)
+            out.emplace_back(board, turn);
+        SearchResult r = engine.think(board, turn, limits);
+        if (r.move >= 0)
+            board.put(r.move % 8, r.move / 8, turn);
+        turn = opponent(turn);
+    }
+    return out;
+}
+
+int runSmpBenchmark(int maxThreads, int depth, size_t hashMB)
+{
+    auto positions = benchPositions();
+    Engine engine(hashMB, 1);
+    SearchLimits limits;
+    limits.seconds = 1e9;
+    limits.maxDepth = depth;
+
+    cout << "Lazy SMP time-to-depth: 8x8, depth " << depth << ", " << positions.size()
+         << " positions, " << engine.hashSizeMB() << " MB hash" << endl;
+    cout << "threads   seconds          nodes     Mnps  speedup  same move" << endl;
+
+    double baseSeconds = 0;
+    vector<int> baseMoves;
+    for (int threads = 1; ; threads = min(threads * 2, maxThreads)) {
+        engine.setThreads(threads);
+        double seconds = 0;
+        uint64_t nodes = 0;
+        int same = 0;
+        for (size_t i = 0; i < positions.size(); i++) {
+            engine.clearHash();
+            SearchResult r = engine.think(positions[i].first, positions[i].second, limits);
+            seconds += r.seconds;
+            nodes += r.nodes;
+            if (threads == 1)
+                baseMoves.push_back(r.move);
+            same += r.move == baseMoves[i];
+        }
+        if (threads == 1)
+            baseSeconds = seconds;
+
+        cout << setw(7) << threads
+             << fixed << setprecision(3) << setw(10) << seconds
+             << setw(15) << nodes
+             << setprecision(1) << setw(9) << (seconds > 0 ? nodes / seconds / 1e6 : 0.0)
+             << setprecision(2) << setw(9) << (seconds > 0 ? baseSeconds / seconds : 0.0)
+             << setw(8) << same << "/" << positions.size() << endl;
+
+        if (threads >= maxThreads)
+            break;
+    }
+    return 0;
+}
+
+namespace {
+
+struct EvalSample {
+    Board<8> board;
+    PatternFeatures features;
+    nnue::Accumulator accumulator;
+    Board<8>::Undo last;
+    Disk turn;
+    uint8_t phase;
+};
+
+// Positions from random games, with the pattern indices and the network
+// accumulator kept up to date incrementally along the way.
+vector<EvalSample> evalSamples(size_t count, const Network& net)
+{
+    vector<EvalSample> out;
+    mt19937 rng(12345);
+    while (out.size() < count) {
+        EvalSample s{ Board<8>(), {}, {}, {}, Disk::X, 0 };
+        PatternEval::init(s.features, s.board);
+        net.init(s.accumulator, s.board);
+        for (int passes = 0; passes < 2 && out.size() < count; ) {
+            uint64_t moves = s.board.moves(s.turn);
+            if (!moves) {
+                passes++;
+                s.turn = opponent(s.turn);
+                continue;
+            }
+            passes = 0;
+            int pick = (int)(rng() % bitboard::popcount(moves));
+            while (pick-- > 0)
+                moves &= moves - 1;
+            int sq = bitboard::popLowest(moves);
+            s.last = s.board.play(sq, s.turn);
+            PatternEval::play(s.features, sq, s.turn, s.last.flipped);
+            net.play(s.accumulator, sq, s.turn, s.last.flipped);
+            s.turn = opponent(s.turn);
+            s.phase = (uint8_t)patterns::phaseOf(64 - s.board.count(Disk::Empty));
+            out.push_back(s);
+        }
+    }
+    return out;
+}
+
+template <class F>
+double timeRounds(int rounds, F&& f)
+{
+    auto t0 = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+        f();
+    return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+void report(const char* name, double seconds, size_t evals, double baseNs, int64_t checksum)
+{
+    double ns = seconds * 1e9 / evals;
+    cout << left << setw(28) << name << right << fixed
+         << setprecision(1) << setw(10) << evals / seconds / 1e6 << " M/s"
+         << setprecision(2) << setw(9) << ns << " ns"
+         << setprecision(2) << setw(8) << (baseNs > 0 ? ns / baseNs : 1.0) << "x movegen"
+         << "   (" << checksum << ")" << endl;
+}
+
+} // namespace
+
+int runEvalBenchmark(const PatternEval& patterns, const Network& net)
+{
+    const int ROUNDS = 20;
+    auto samples = evalSamples(100000, net);
+    size_t evals = samples.size() * ROUNDS;
+    int64_t sum = 0;
+
+    cout << "Evaluation benchmark: " << samples.size() << " positions x " << ROUNDS << " rounds" << endl;
+
+    double secs = timeRounds(ROUNDS, [&] {
+        for (auto& s : samples) sum += bitboard::popcount(s.board.moves(s.turn));
+    });
+    double moveNs = secs * 1e9 / evals;
+    report("move generation", secs, evals, moveNs, sum);
+
+    sum = 0;
+    secs = timeRounds(ROUNDS, [&] {
+        for (auto& s : samples) sum += evaluate(s.board, s.turn);
+    });
+    report("square weights + mobility", secs, evals, moveNs, sum);
+
+    sum = 0;
+    secs = timeRounds(ROUNDS, [&] {
+        for (auto& s : samples) sum += patterns.score(s.features, 64 - s.board.count(Disk::Empty), s.turn);
+    });
+    report("patterns, one at a time", secs, evals, moveNs, sum);
+
+    vector<PatternFeatures> features;
+    vector<uint8_t> phases;
+    for (auto& s : samples) {
+        features.push_back(s.features);
+        phases.push_back(s.phase);
+    }
+    vector<int32_t> scores(samples.size());
+    for (bool scalar : { true, false }) {
+        patterns::useScalarBatch(scalar);
+        sum = 0;
+        secs = timeRounds(ROUNDS, [&] {
+            patterns.scoreBatch(features.data(), phases.data(), (int)features.size(), scores.data());
+            for (int32_t v : scores) sum += v / patterns::WEIGHT_SCALE;
+        });
+        string name = string("patterns, batch (") + patterns.batchKernelName() + ")";
+        report(name.c_str(), secs, evals, moveNs, sum);
+    }
+    patterns::useScalarBatch(false);
+
+    // The accumulator update is what every search node pays on top of the
+    // head: take the last move back and play it again.
+    sum = 0;
+    secs = timeRounds(ROUNDS, [&] {
+        for (auto& s : samples) {
+            net.undo(s.accumulator, s.last.sq, s.last.who, s.last.flipped);
+            net.play(s.accumulator, s.last.sq, s.last.who, s.last.flipped);
+            sum += s.accumulator.v[0];
+        }
+    });
+    report("nnue, undo + play update", secs, evals, moveNs, sum);
+
+    for (auto kernel : { nnue::Kernel::SCALAR, nnue::Kernel::SSE4, nnue::Kernel::AVX2 }) {
+        if (!nnue::useKernel(kernel))
+            continue;
+        sum = 0;
+        secs = timeRounds(ROUNDS, [&] {
+            for (auto& s : samples) sum += net.score(s.accumulator, s.turn);
+        });
+        string name = string("nnue head (") + net.kernelName() + ")";
+        report(name.c_str(), secs, evals, moveNs, sum);
+    }
+    nnue::useKernel(nnue::Kernel::AUTO);
+    return 0;
+}
+
+int runMctsBenchmark(int maxThreads, double seconds, size_t treeMB)
+{
+    Engine engine(1, 1);
+    engine.setAlgorithm(Algorithm::MCTS);
+    engine.setTreeSize(treeMB);
+    SearchLimits limits;
+    limits.seconds = seconds;
+    limits.exactEmpties = 0;
+
+    cout << "MCTS playout rate from the opening position, " << seconds << " s per run, "
+         << treeMB << " MB tree" << endl;
+    cout << "size  threads   playouts/s  playouts/min  depth  move" << endl;
+
+    for (int size : { 8, 10, 12 }) {
+        AnyBoard board(size);
+        for (int threads = 1; ; threads = min(threads * 2, maxThreads)) {
+            engine.setThreads(threads);
+            engine.newGame();
+            SearchResult r = engine.think(board, Disk::X, limits);
+            double rate = r.seconds > 0 ? r.nodes / r.seconds : 0.0;
+            cout << setw(4) << size << setw(9) << threads
+                 << fixed << setprecision(0) << setw(13) << rate
+                 << setw(14) << rate * 60
+                 << setw(7) << r.depth
+                 << setw(6) << r.move << endl;
+            if (threads >= maxThreads)
+                break;
+        }
+    }
+    return 0;
+}
@@ -1,154 +1,94 @@
 #include "board.hpp"
 
-#include <cassert>
-#include <cstring>
-
-Board::Board(int size, bool initial) : boardSize(size)
+static std::variant<BoardState<8>, BoardState<10>, BoardState<12>> makeBoard(int size)
 {
-    // Allocate 2D array
-    grid = new Disk*[boardSize];
-    for (int i = 0; i < boardSize; i++) {
-        grid[i] = new Disk[boardSize];
+    switch (size) {
+    case 10: return BoardState<10>();
+    case 12: return BoardState<12>();
+    default: return BoardState<8>();
     }
-
-    for (int y = 0; y < boardSize; y++)
-        for (int x = 0; x < boardSize; x++)
-            grid[y][x] = Disk::Empty;
-
-    if (initial)
-        reset();
 }
 
-Board::~Board()
+AnyBoard::AnyBoard(int size) : impl(makeBoard(size))
 {
-    for (int i = 0; i < boardSize; i++) {
-        delete[] grid[i];
-    }
-    delete[] grid;
+    reset();
 }
 
-void Board::reset()
+int AnyBoard::getSize() const
 {
-    for (int y = 0; y < boardSize; y++)
-        for (int x = 0; x < boardSize; x++)
-            grid[y][x] = Disk::Empty;
-
-    // Set initial pieces in center
-    int center = boardSize / 2;
-    grid[center-1][center-1] = Disk::O;
-    grid[center-1][center] = Disk::X;
-    grid[center][center-1] = Disk::X;
-    grid[center][center] = Disk::O;
+    return visit([](const auto& b) { return b.getSize(); });
 }
 
-Board::Disk Board::get(int x, int y) const
+void AnyBoard::reset()
 {
-    return grid[y][x];
+    std::visit([](auto& s) {
+        s.board.reset();
+        s.undos.clear();
+    }, impl);
+
+    int size = getSize();
+    discs[(int)Disk::X] = 2;
+    discs[(int)Disk::O] = 2;
+    discs[(int)Disk::Empty] = size * size - 4;
+    positionChanged();
 }
 
-bool Board::scan(int startX, int startY, int dx, int dy, Disk current) const
+bool AnyBoard::isValid(int x, int y, Disk current) const
 {
-    int x = startX + dx;
-    int y = startY + dy;
-    bool anyOther = false;
-
-    while (x >= 0 && x < boardSize && y >= 0 && y < boardSize) {
-        if (grid[y][x] == Disk::Empty)
-            return false;
-
-        if (grid[y][x] == current)
-            return anyOther;
-
-        anyOther = true;
-        x += dx;
-        y += dy;
-    }
-
+    for (auto& m : getValid(current))
+        if (m.first == x && m.second == y)
+            return true;
     return false;
 }
 
-bool Board::isValid(int x, int y, Disk current) const
+const std::vector<std::pair<int, int>>& AnyBoard::getValid(Disk current) const
 {
-    if (grid[y][x] != Disk::Empty)
-        return false;
-
-    return scan(x, y, 0, 1, current) ||
-           scan(x, y, 1, 0, current) ||
-           scan(x, y, 0, -1, current) ||
-           scan(x, y, -1, 0, current) ||
-           scan(x, y, 1, 1, current) ||
-           scan(x, y, 1, -1, current) ||
-           scan(x, y, -1, 1, current) ||
-           scan(x, y, -1, -1, current);
-}
-
-std::vector<std::pair<int, int>> Board::getValid(Disk current) const
-{
-    std::vector<std::pair<int, int>> out;
-    for (int y = 0; y < boardSize; y++) {
-        for (int x = 0; x < boardSize; x++) {
-            if (isValid(x, y, current))
-                out.emplace_back(x, y);
-        }
+    int side = current == Disk::X ? 0 : 1;
+    if (!validFresh[side]) {
+        validCache[side] = visit([&](const auto& b) { return b.getValid(current); });
+        validFresh[side] = true;
     }
-    return out;
+    return validCache[side];
 }
 
-void Board::scanAndFlip(int startX, int startY, int dx, int dy)
+void AnyBoard::put(int x, int y, Disk current)
 {
-    int x = startX;
-    int y = startY;
-
-    bool anyOther = false;
-    Disk border = grid[y][x];
-
-    while (true) {
-        x += dx;
-        y += dy;
-        if (x < 0 || x >= boardSize || y < 0 || y >= boardSize)
-            return;
-        if (grid[y][x] == Disk::Empty)
-            return;
-        if (grid[y][x] == border) {
-            if (!anyOther)
-                return;
-            // flip back towards start
-            int fx = startX + dx;
-            int fy = startY + dy;
-            while (fx != x || fy != y) {
-                grid[fy][fx] = border;
-                fx += dx;
-                fy += dy;
-            }
-            return;
-        }
-        anyOther = true;
-    }
+    int flipped = std::visit([&](auto& s) {
+        s.undos.push_back(s.board.put(x, y, current));
+        return bitboard::popcount(s.undos.back().flipped);
+    }, impl);
+
+    discs[(int)current] += flipped + 1;
+    discs[(int)opponent(current)] -= flipped;
+    discs[(int)Disk::Empty]--;
+    positionChanged();
 }
 
-void Board::put(int x, int y, Disk current)
+bool AnyBoard::undo()
 {
-    assert(grid[y][x] == Disk::Empty);
-    grid[y][x] = current;
-
-    scanAndFlip(x, y, 0, 1);
-    scanAndFlip(x, y, 1, 0);
-    scanAndFlip(x, y, 0, -1);
-    scanAndFlip(x, y, -1, 0);
-    scanAndFlip(x, y, 1, 1);
-    scanAndFlip(x, y, 1, -1);
-    scanAndFlip(x, y, -1, 1);
-    scanAndFlip(x, y, -1, -1);
+    Disk who = Disk::Empty;
+    int flipped = std::visit([&](auto& s) {
+        if (s.undos.empty())
+            return 0;
+        auto& u = s.undos.back();
+        s.board.undo(u);
+        who = u.who;
+        int n = bitboard::popcount(u.flipped);
+        s.undos.pop_back();
+        return n;
+    }, impl);
+
+    if (who == Disk::Empty)
+        return false;
+    discs[(int)who] -= flipped + 1;
+    discs[(int)opponent(who)] += flipped;
+    discs[(int)Disk::Empty]++;
+    positionChanged();
+    return true;
 }
 
-int Board::count(Disk who) const
+Disk AnyBoard::get(int x, int y) const
 {
-    int c = 0;
-    for (int y = 0; y < boardSize; y++)
-        for (int x = 0; x < boardSize; x++)
-            if (grid[y][x] == who)
-                c++;
-    return c;
+    return visit([&](const auto& b) { return b.get(x, y); });
 }
 
-
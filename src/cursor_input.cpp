@@ -1,54 +1,83 @@
 #include "cursor_input.hpp"
-#include "utils.hpp"
-#include <iostream>
-#include <termios.h>
-#include <unistd.h>     // for read()
-#include <fcntl.h>      // for fcntl()
 
 using namespace std;
 
-InputKey getInputKey() {
-    struct termios oldt, newt;
-    tcgetattr(STDIN_FILENO, &oldt);
-    newt = oldt;
-
-    newt.c_lflag &= ~(ICANON | ECHO); // Disable canonical mode
-    tcsetattr(STDIN_FILENO, TCSANOW, &newt);
-
-    InputKey key = InputKey::NONE;
-    char ch;
+static InputKey keyForChar(char ch)
+{
+    switch (ch) {
+        case 'w': case 'W': return InputKey::UP;
+        case 's': case 'S': return InputKey::DOWN;
+        case 'a': case 'A': return InputKey::LEFT;
+        case 'd': case 'D': return InputKey::RIGHT;
+        case '\n': case '\r': return InputKey::ENTER;
+        case 'q': case 'Q': return InputKey::Q;
+        case 'r': case 'R': return InputKey::R;
+        case 'u': case 'U': return InputKey::U;
+        case '[': return InputKey::LEFT_BRACKET;
+        case ']': return InputKey::RIGHT_BRACKET;
+        default:  return InputKey::NONE;
+    }
+}
 
-    // Use a single blocking read to wait for a keypress
-    read(STDIN_FILENO, &ch, 1);
+static InputKey arrowKey(char final)
+{
+    switch (final) {
+        case 'A': return InputKey::UP;
+        case 'B': return InputKey::DOWN;
+        case 'C': return InputKey::RIGHT;
+        case 'D': return InputKey::LEFT;
+        default:  return InputKey::NONE;
+    }
+}
 
-    if (ch == '\033') {
-        char seq[2];
-        read(STDIN_FILENO, &seq[0], 1);
-        read(STDIN_FILENO, &seq[1], 1);
-        switch (seq[1]) {
-            case 'A': key = InputKey::UP; break;
-            case 'B': key = InputKey::DOWN; break;
-            case 'C': key = InputKey::RIGHT; break;
-            case 'D': key = InputKey::LEFT; break;
-        }
-    } else {
-        switch (ch) {
-            case 'w': case 'W': key = InputKey::UP; break;
-            case 's': case 'S': key = InputKey::DOWN; break;
-            case 'a': case 'A': key = InputKey::LEFT; break;
-            case 'd': case 'D': key = InputKey::RIGHT; break;
-            case '\n': key = InputKey::ENTER; break;
-            case 27:   key = InputKey::ESC; break;
-            case 'q': case 'Q': key = InputKey::Q; break;
-            case 'r': case 'R': key = InputKey::R; break;
-            case '[': key = InputKey::LEFT_BRACKET; break;
-            case ']': key = InputKey::RIGHT_BRACKET; break;
-            default:   key = InputKey::NONE; break;
+void KeyDecoder::feed(const char* bytes, size_t n, vector<Key>& out)
+{
+    for (size_t i = 0; i < n; i++) {
+        char ch = bytes[i];
+        switch (state) {
+            case GROUND:
+                if (ch == 27)
+                    state = ESCAPE;
+                else
+                    out.push_back({ keyForChar(ch), ch });
+                break;
+            case ESCAPE:
+                if (ch == '[') {
+                    state = CSI;
+                } else if (ch == 'O') {
+                    state = SS3;    // arrows in application cursor mode
+                } else {
+                    // ESC then an ordinary key (or another ESC)
+                    out.push_back({ InputKey::ESC, 0 });
+                    state = GROUND;
+                    feed(&ch, 1, out);
+                }
+                break;
+            case CSI:
+                // Parameters (e.g. modifiers in ESC [ 1 ; 5 A) until the final byte
+                if (ch >= 0x40 && ch <= 0x7E) {
+                    InputKey key = arrowKey(ch);
+                    if (key != InputKey::NONE)
+                        out.push_back({ key, 0 });
+                    state = GROUND;
+                }
+                break;
+            case SS3: {
+                InputKey key = arrowKey(ch);
+                if (key != InputKey::NONE)
+                    out.push_back({ key, 0 });
+                state = GROUND;
+                break;
+            }
         }
     }
+}
 
-    tcsetattr(STDIN_FILENO, TCSANOW, &oldt); // Restore original settings
-    return key;
+void KeyDecoder::timeout(vector<Key>& out)
+{
+    if (state == ESCAPE)
+        out.push_back({ InputKey::ESC, 0 });
+    state = GROUND; // an unfinished sequence is dropped
 }
 
 // void playSound(SoundEffect effect) {
@@ -57,4 +86,4 @@ InputKey getInputKey() {
 //         case VICTORY: system("aplay sounds/victory.wav &"); break;
 //         case DEFEAT:  system("aplay sounds/defeat.wav &"); break;
 //     }
-// }
\ No newline at end of file
+// }
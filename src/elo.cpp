@@ -0,0 +1,116 @@
+#include "elo.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace elo {
+
+namespace {
+
+// Scores of exactly 0 or 1 have no finite Elo
+constexpr double EPSILON = 1e-6;
+constexpr double Z95 = 1.959964;
+constexpr double REGULARIZE = 1e-3;
+
+double clampScore(double s)
+{
+    return min(1 - EPSILON, max(EPSILON, s));
+}
+
+} // namespace
+
+double fromScore(double score)
+{
+    score = clampScore(score);
+    return 400 * log10(score / (1 - score));
+}
+
+double toScore(double elo)
+{
+    return 1 / (1 + pow(10, -elo / 400));
+}
+
+uint64_t Pentanomial::count() const
+{
+    uint64_t n = 0;
+    for (uint64_t p : pairs)
+        n += p;
+    return n;
+}
+
+double Pentanomial::score() const
+{
+    uint64_t n = count();
+    if (!n)
+        return 0.5;
+    double sum = 0;
+    for (int i = 0; i < 5; i++)
+        sum += pairs[i] * (i / 4.0);
+    return sum / n;
+}
+
+double Pentanomial::variance() const
+{
+    uint64_t n = count();
+    if (!n)
+        return 0;
+    double mean = score(), sum = 0;
+    for (int i = 0; i < 5; i++)
+        sum += pairs[i] * (i / 4.0 - mean) * (i / 4.0 - mean);
+    return sum / n;
+}
+
+double Pentanomial::elo() const
+{
+    return fromScore(score());
+}
+
+double Pentanomial::errorMargin() const
+{
+    uint64_t n = count();
+    if (n < 2)
+        return 0;
+    double s = score(), margin = Z95 * sqrt(variance() / n);
+    return (fromScore(s + margin) - fromScore(s - margin)) / 2;
+}
+
+double Pentanomial::llr(double elo0, double elo1) const
+{
+    uint64_t n = count();
+    if (n < 2)
+        return 0;
+    // Outcomes not seen yet count as a thousandth of a pair, so that a run
+    // of identical results (no variance) still gives a finite ratio
+    double counts[5], total = 0, mean = 0, var = 0;
+    for (int i = 0; i < 5; i++) {
+        counts[i] = pairs[i] ? (double)pairs[i] : REGULARIZE;
+        total += counts[i];
+        mean += counts[i] * (i / 4.0);
+    }
+    mean /= total;
+    for (int i = 0; i < 5; i++)
+        var += counts[i] * (i / 4.0 - mean) * (i / 4.0 - mean);
+    var /= total;
+    double s0 = toScore(elo0), s1 = toScore(elo1);
+    return n * (s1 - s0) * (2 * mean - s0 - s1) / (2 * var);
+}
+
+double Sprt::lower() const
+{
+    return log(beta / (1 - alpha));
+}
+
+double Sprt::upper() const
+{
+    return log((1 - beta) / alpha);
+}
+
+int Sprt::decide(const Pentanomial& p) const
+{
+    double l = p.llr(elo0, elo1);
+    return l >= upper() ? 1 : l <= lower() ? -1 : 0;
+}
+
+} // namespace elo
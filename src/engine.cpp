@@ -0,0 +1,143 @@
+#include "engine.hpp"
+
+#include <algorithm>
+#include <type_traits>
+
+double moveBudget(double remaining, double increment, int empties)
+{
+    int movesLeft = std::max(4, (empties + 1) / 2);
+    return std::max(0.001, std::min(remaining / movesLeft + increment, remaining / 2));
+}
+
+Engine::Engine(size_t hashMB, int threads) : tt(hashMB)
+{
+    setThreads(threads);
+}
+
+void Engine::setThreads(int threads)
+{
+    stopPonder();
+    if (threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    search8.assign(threads, Search<8>(&tt));
+    applyEvaluator();
+    search10.assign(threads, Search<10>(&tt));
+    search12.assign(threads, Search<12>(&tt));
+}
+
+SearchResult Engine::think(const AnyBoard& board, Disk side, const SearchLimits& limits,
+                           const ProgressFn& progress, std::atomic<bool>* stop)
+{
+    bool afterPonder = pondered;
+    stopPonder();
+    pondered = false;
+    BookMove known;
+    if (book && book->probe(board, side, known)) {
+        SearchResult r;
+        r.move = known.move;
+        r.score = known.score;
+        r.depth = known.depth;
+        r.book = true;
+        return r;
+    }
+    return board.visit([&](const auto& b) {
+        constexpr int N = std::decay_t<decltype(b)>::SIZE;
+        SearchResult r;
+        if (afterPonder && ponderHit<N>(b, side, limits, r))
+            return r;
+        if (usesMcts(b, limits)) {
+            r = runMcts<N>(b, side, limits, stop, progress ? &progress : nullptr);
+            lastPlayouts = r.nodes;
+        } else {
+            r = runThreads<N>(b, side, limits, stop, progress ? &progress : nullptr);
+            lastDepth = r.depth;
+        }
+        return r;
+    });
+}
+
+void Engine::startPonder(const AnyBoard& board, Disk toMove, const SearchLimits& limits)
+{
+    stopPonder();
+    SearchLimits forever = limits;
+    forever.seconds = 1e9; // until stopPonder(), or the search runs out of depth
+    ponderStop.store(false);
+    pondered = true;
+    board.visit([&](const auto& b) {
+        ponderThread = std::thread([this, root = b, toMove, forever] {
+            constexpr int N = std::decay_t<decltype(root)>::SIZE;
+            if (usesMcts(root, forever))
+                runMcts<N>(root, toMove, forever, &ponderStop);
+            else
+                runThreads<N>(root, toMove, forever, &ponderStop);
+        });
+    });
+}
+
+void Engine::stopPonder()
+{
+    if (!ponderThread.joinable())
+        return;
+    ponderStop.store(true);
+    ponderThread.join();
+}
+
+EndgameResult Engine::solve(const AnyBoard& board, Disk side)
+{
+    stopPonder();
+    return board.visit([&](const auto& b) {
+        constexpr int N = std::decay_t<decltype(b)>::SIZE;
+        return searchFor<N>()[0].solve(b, side);
+    });
+}
+
+bool Engine::loadPatterns(const std::string& path, std::string* error)
+{
+    auto eval = std::make_unique<PatternEval>();
+    if (!eval->load(path, error))
+        return false;
+    stopPonder();   // its searches point at the evaluator being replaced
+    patternEval = std::move(eval);
+    setEvaluator(EvalKind::PATTERNS);
+    return true;
+}
+
+bool Engine::loadNetwork(const std::string& path, std::string* error)
+{
+    auto net = std::make_unique<Network>();
+    if (!net->load(path, error))
+        return false;
+    stopPonder();   // its searches point at the network being replaced
+    network = std::move(net);
+    setEvaluator(EvalKind::NNUE);
+    return true;
+}
+
+bool Engine::loadBook(const std::string& path, std::string* error)
+{
+    auto opened = std::make_unique<OpeningBook>();
+    if (!opened->open(path, error))
+        return false;
+    stopPonder();
+    book = std::move(opened);
+    return true;
+}
+
+void Engine::setEvaluator(EvalKind kind)
+{
+    stopPonder();
+    if (kind == EvalKind::PATTERNS && !patternEval)
+        patternEval = std::make_unique<PatternEval>();
+    if (kind == EvalKind::NNUE && !network)
+        network = std::make_unique<Network>();
+    evalKind = kind;
+    applyEvaluator();
+}
+
+void Engine::applyEvaluator()
+{
+    const PatternEval* patterns = evalKind == EvalKind::PATTERNS ? patternEval.get() : nullptr;
+    const Network* net = evalKind == EvalKind::NNUE ? network.get() : nullptr;
+    for (auto& s : search8)
+        s.setEvaluator(patterns, net);
+}
@@ -0,0 +1,182 @@
+#include "engine_worker.hpp"
+
+#include <utility>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using namespace std;
+
+EngineWorker::EngineWorker(Engine& engine) : engine(engine)
+{
+    eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    thread = std::thread([this] { loop(); });
+}
+
+EngineWorker::~EngineWorker()
+{
+    {
+        lock_guard<mutex> lock(queueMutex);
+        requests.clear();
+        cancelled = true;
+        stopFlag.store(true);
+        Request quit;
+        quit.type = Request::QUIT;
+        requests.push_back(move(quit));
+    }
+    wake.notify_one();
+    thread.join();
+    engine.stopPonder();
+    if (eventFd >= 0)
+        close(eventFd);
+}
+
+uint64_t EngineWorker::search(const AnyBoard& board, Disk side, const SearchLimits& limits)
+{
+    Request r;
+    r.type = Request::SEARCH;
+    r.board = board;
+    r.side = side;
+    r.limits = limits;
+    uint64_t id;
+    {
+        lock_guard<mutex> lock(queueMutex);
+        id = r.id = ++nextId;
+        requests.push_back(move(r));
+    }
+    wake.notify_one();
+    return id;
+}
+
+void EngineWorker::ponder(const AnyBoard& board, Disk toMove, const SearchLimits& limits)
+{
+    Request r;
+    r.type = Request::PONDER;
+    r.board = board;
+    r.side = toMove;
+    r.limits = limits;
+    {
+        lock_guard<mutex> lock(queueMutex);
+        requests.push_back(move(r));
+    }
+    wake.notify_one();
+}
+
+void EngineWorker::stop()
+{
+    {
+        lock_guard<mutex> lock(queueMutex);
+        for (auto it = requests.begin(); it != requests.end(); )
+            it = it->type == Request::SEARCH || it->type == Request::PONDER ? requests.erase(it) : it + 1;
+        if (running) {
+            cancelled = true;
+            stopFlag.store(true);
+        }
+        // The ponder threads are joined on the worker, not here
+        Request r;
+        r.type = Request::STOP;
+        requests.push_back(move(r));
+    }
+    wake.notify_one();
+}
+
+void EngineWorker::call(const function<void(Engine&)>& fn)
+{
+    unique_lock<mutex> lock(queueMutex);
+    Request r;
+    r.type = Request::CALL;
+    r.fn = fn;
+    requests.push_back(move(r));
+    uint64_t ticket = ++callsQueued;
+    wake.notify_one();
+    called.wait(lock, [&] { return callsDone >= ticket; });
+}
+
+bool EngineWorker::poll(Response& out)
+{
+    lock_guard<mutex> lock(queueMutex);
+    if (responses.empty())
+        return false;
+    out = move(responses.front());
+    responses.pop_front();
+    return true;
+}
+
+void EngineWorker::respond(Response r)
+{
+    {
+        lock_guard<mutex> lock(queueMutex);
+        if (r.type == Response::PROGRESS && !responses.empty() &&
+            responses.back().type == Response::PROGRESS && responses.back().id == r.id)
+            responses.back() = move(r);
+        else
+            responses.push_back(move(r));
+    }
+    if (eventFd >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = write(eventFd, &one, sizeof one);
+        (void)ignored;
+    }
+}
+
+void EngineWorker::loop()
+{
+    while (true) {
+        Request r;
+        {
+            unique_lock<mutex> lock(queueMutex);
+            wake.wait(lock, [&] { return !requests.empty(); });
+            r = move(requests.front());
+            requests.pop_front();
+            if (r.type == Request::SEARCH) {
+                running = r.id;
+                cancelled = false;
+                stopFlag.store(false);
+            }
+        }
+
+        switch (r.type) {
+            case Request::SEARCH:
+                runSearch(r);
+                break;
+            case Request::PONDER:
+                engine.startPonder(r.board, r.side, r.limits);
+                break;
+            case Request::STOP:
+                engine.stopPonder();
+                break;
+            case Request::CALL:
+                r.fn(engine);
+                {
+                    lock_guard<mutex> lock(queueMutex);
+                    callsDone++;
+                }
+                called.notify_all();
+                break;
+            case Request::QUIT:
+                return;
+        }
+    }
+}
+
+void EngineWorker::runSearch(const Request& r)
+{
+    Response progress;
+    progress.type = Response::PROGRESS;
+    progress.id = r.id;
+    auto report = [&](const SearchProgress& p) {
+        progress.progress = p;
+        respond(progress);
+    };
+
+    Response done;
+    done.type = Response::RESULT;
+    done.id = r.id;
+    done.result = engine.think(r.board, r.side, r.limits, report, &stopFlag);
+    {
+        lock_guard<mutex> lock(queueMutex);
+        done.cancelled = cancelled;
+        running = 0;
+    }
+    respond(move(done));
+}
@@ -0,0 +1,22 @@
+#include "file_io.hpp"
+
+#include <cerrno>
+#include <cstdint>
+
+#include <unistd.h>
+
+bool writeAll(int fd, const void* data, size_t size)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = write(fd, p, size);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
@@ -0,0 +1,225 @@
+#include "frame.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <cstdio>
+#else
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+void Frame::resize(int c, int r)
+{
+    cols = max(0, c);
+    rows = max(0, r);
+    cells.assign((size_t)cols * rows, Cell());
+    clear();
+}
+
+void Frame::clear()
+{
+    fill(cells.begin(), cells.end(), Cell());
+    penX = penY = 1;
+    pen = DEFAULT;
+}
+
+void Frame::clear(int x, int y, int width, int height)
+{
+    int x0 = max(1, x), x1 = min(cols, x + width - 1);
+    int y0 = max(1, y), y1 = min(rows, y + height - 1);
+    for (int row = y0; row <= y1; row++)
+        for (int col = x0; col <= x1; col++)
+            cells[(row - 1) * cols + col - 1] = Cell();
+}
+
+void Frame::put(uint32_t ch)
+{
+    if (penX >= 1 && penX <= cols && penY >= 1 && penY <= rows) {
+        Cell& c = cells[(penY - 1) * cols + penX - 1];
+        c.ch = ch;
+        c.color = pen;
+    }
+    penX++;
+}
+
+namespace {
+
+// Decodes the code point at s and returns the byte after it. Continuation
+// bytes of a malformed sequence are taken as they come.
+const unsigned char* decodeUtf8(const unsigned char* s, uint32_t& ch)
+{
+    ch = *s++;
+    int more = ch >= 0xF0 ? 3 : ch >= 0xE0 ? 2 : ch >= 0xC0 ? 1 : 0;
+    if (more)
+        ch &= 0x3F >> more;
+    for (; more && (*s & 0xC0) == 0x80; more--)
+        ch = (ch << 6) | (*s++ & 0x3F);
+    return s;
+}
+
+} // namespace
+
+Frame& Frame::operator<<(const char* text)
+{
+    auto s = reinterpret_cast<const unsigned char*>(text);
+    while (*s) {
+        uint32_t ch;
+        s = decodeUtf8(s, ch);
+        if (ch == '\n') {
+            penX = 1;
+            penY++;
+        } else {
+            put(ch);
+        }
+    }
+    return *this;
+}
+
+Frame& Frame::operator<<(char c)
+{
+    char text[2] = { c, 0 };
+    return *this << text;
+}
+
+void Frame::field(const string& text, int width)
+{
+    auto s = reinterpret_cast<const unsigned char*>(text.c_str());
+    for (int i = 0; i < width; i++) {
+        uint32_t ch = ' ';
+        if (*s)
+            s = decodeUtf8(s, ch);
+        put(ch);
+    }
+}
+
+int encodeUtf8(uint32_t ch, char* out)
+{
+    if (ch < 0x80) {
+        out[0] = (char)ch;
+        return 1;
+    }
+    if (ch < 0x800) {
+        out[0] = (char)(0xC0 | (ch >> 6));
+        out[1] = (char)(0x80 | (ch & 0x3F));
+        return 2;
+    }
+    if (ch < 0x10000) {
+        out[0] = (char)(0xE0 | (ch >> 12));
+        out[1] = (char)(0x80 | ((ch >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (ch & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (ch >> 18));
+    out[1] = (char)(0x80 | ((ch >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((ch >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (ch & 0x3F));
+    return 4;
+}
+
+FrameOutput::FrameOutput(size_t capacity) : buf(capacity) {}
+
+void FrameOutput::append(const char* s, size_t n)
+{
+    if (used + n > buf.size())
+        buf.resize(max(buf.size() * 2, used + n));
+    memcpy(buf.data() + used, s, n);
+    used += n;
+}
+
+void FrameOutput::appendNumber(int n)
+{
+    char digits[12];
+    int len = 0;
+    do {
+        digits[len++] = (char)('0' + n % 10);
+        n /= 10;
+    } while (n);
+    while (len)
+        append(&digits[--len], 1);
+}
+
+static int digitCount(int n)
+{
+    return n >= 100 ? 3 : n >= 10 ? 2 : 1;
+}
+
+int FrameOutput::moveCost(int toX, int toY) const
+{
+    if (toX == x && toY == y)
+        return 0;
+    int absolute = 4 + digitCount(toY) + digitCount(toX);          // ESC [ y ; x H
+    if (toY == y && toX > x && x > 0)
+        return min(absolute, 3 + digitCount(toX - x));              // ESC [ n C
+    return absolute;
+}
+
+void FrameOutput::moveTo(int toX, int toY)
+{
+    if (toX == x && toY == y)
+        return;
+    if (toY == y && toX > x && x > 0 && 3 + digitCount(toX - x) < 4 + digitCount(toY) + digitCount(toX)) {
+        append("\033[", 2);
+        appendNumber(toX - x);
+        append("C", 1);
+    } else {
+        append("\033[", 2);
+        appendNumber(toY);
+        append(";", 1);
+        appendNumber(toX);
+        append("H", 1);
+    }
+    x = toX;
+    y = toY;
+}
+
+void FrameOutput::clearScreen()
+{
+    append("\033[2J\033[H", 7);
+    x = y = 1;
+}
+
+void FrameOutput::setColor(uint8_t color)
+{
+    if (color == pen)
+        return;
+    append("\033[", 2);
+    appendNumber(color);
+    append("m", 1);
+    pen = color;
+}
+
+void FrameOutput::glyph(uint32_t ch)
+{
+    char bytes[4];
+    append(bytes, encodeUtf8(ch, bytes));
+    if (x > 0)
+        x++;
+}
+
+size_t FrameOutput::flush()
+{
+    // Anything still buffered in cout (menus, messages) goes first
+    cout.flush();
+    size_t bytes = used;
+#ifdef _WIN32
+    fwrite(buf.data(), 1, used, stdout);
+    fflush(stdout);
+#else
+    for (size_t done = 0; done < used; ) {
+        ssize_t n = write(STDOUT_FILENO, buf.data() + done, used - done);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        done += (size_t)n;
+    }
+#endif
+    used = 0;
+    return bytes;
+}
@@ -0,0 +1,31 @@
+#include "frame_scheduler.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+void FrameScheduler::setRate(int hz)
+{
+    interval = chrono::duration_cast<Clock::duration>(chrono::duration<double>(1.0 / max(1, hz)));
+}
+
+int FrameScheduler::timeout(Clock::time_point now) const
+{
+    if (!dirty)
+        return -1;
+    auto wait = last + interval - now;
+    if (wait <= Clock::duration::zero())
+        return 0;
+    // Rounded up: waking a little early would only mean another poll()
+    return (int)chrono::ceil<chrono::milliseconds>(wait).count();
+}
+
+unsigned FrameScheduler::take(Clock::time_point now)
+{
+    if (!dirty || now < last + interval)
+        return 0;
+    unsigned regions = dirty;
+    dirty = 0;
+    last = now;
+    return regions;
+}
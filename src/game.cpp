@@ -1,11 +1,14 @@
 #include "game.hpp"
 
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
-#include <thread>
+#include <sstream>
 
 using namespace std;
 
-Game::Game() : board(nullptr), turn(Board::Disk::X), cursorX(0), cursorY(0), isRunning(true), boardSize(8)
+Game::Game() : board(nullptr), turn(Disk::X), cursorX(0), cursorY(0), isRunning(true), boardSize(8),
+               computerPlays{ false, false }, lastSearchSide(Disk::X)
 {
     startTime = std::chrono::steady_clock::now();
 }
@@ -17,130 +20,190 @@ Game::~Game()
 
 void Game::run()
 {
-    showMenu();
+    TerminalSession session; // keys unbuffered and unechoed, menus included
+    if (!resumeGame())
+        showMenu();
     
     if (!board) return; // User cancelled menu
     
     hideCursor();
+    events.watchEngine(worker.notifyFd());
+    events.startClock(startTime);
     
-    // Use a non-blocking loop so timer updates even when no keys are pressed
+    // Sleep until a key, the clock's next second, a response from the engine
+    // or the next frame being due; nothing runs in between. Each event marks
+    // what it changed and the scheduler turns them into at most one frame
+    // per display interval.
+    frames.mark(Renderer::ALL);
+    vector<Key> keys;
     while (isRunning) {
-        auto valid = board->getValid(turn);
-        renderer.drawBoard(*board, valid, turn, cursorX, cursorY);
-        renderer.drawSideMenu(moveHistory, board->count(Board::Disk::X), board->count(Board::Disk::O), 
-                 turn, cursorX, cursorY, getElapsedSeconds(), boardSize);
-
-        // Poll input non-blocking
-        InputKey key = InputKey::NONE;
-        if (kbhit()) {
-            int ch = getch();
-            // put character back for existing getInputKey logic that expects to read
-            // but since getInputKey handles termios itself, we map common keys here
-            if (ch == '\n') key = InputKey::ENTER;
-            else if (ch == 27) {
-                // possible arrow escape sequence
-                if (kbhit()) {
-                    int c1 = getch();
-                    if (c1 == '[' && kbhit()) {
-                        int c2 = getch();
-                        if (c2 == 'A') key = InputKey::UP;
-                        else if (c2 == 'B') key = InputKey::DOWN;
-                        else if (c2 == 'C') key = InputKey::RIGHT;
-                        else if (c2 == 'D') key = InputKey::LEFT;
-                    }
-                } else {
-                    key = InputKey::ESC;
-                }
-            }
-            else if (ch == 'w' || ch == 'W') key = InputKey::UP;
-            else if (ch == 's' || ch == 'S') key = InputKey::DOWN;
-            else if (ch == 'a' || ch == 'A') key = InputKey::LEFT;
-            else if (ch == 'd' || ch == 'D') key = InputKey::RIGHT;
-            else if (ch == 'q' || ch == 'Q') key = InputKey::Q;
-            else if (ch == 'r' || ch == 'R') key = InputKey::R;
-            else if (ch == '[') key = InputKey::LEFT_BRACKET;
-            else if (ch == ']') key = InputKey::RIGHT_BRACKET;
-            else if (ch >= '1' && ch <= '9') {
-                // allow quick number input to change board size mid-game (optional)
-            }
-        } else {
-            // No key pressed: small sleep so CPU not pegged, timer will still update on next loop
-            sleep_ms(50);
+        pollEngine();
+        settleTurn();
+        if (!isRunning) break;
+
+        // Computer's turn: the worker searches while this loop keeps drawing the
+        // clock and its progress and reading keys; the move is played when the
+        // result comes back
+        bool hasMoves = !board->getValid(turn).empty();
+        bool engineTurn = isComputer(turn) && hasMoves;
+        if (engineTurn && !searchId) {
+            searchId = worker.search(*board, turn, moveLimits());
+            thinking = SearchProgress();
+            pondering = false;
+            frames.mark(Renderer::STATUS);
         }
 
-        switch (key) {
-            case InputKey::LEFT:  
-                if (cursorX > 0) cursorX--; 
-                break;
-            case InputKey::RIGHT: 
-                if (cursorX < boardSize - 1) cursorX++; 
-                break;
-            case InputKey::UP:    
-                if (cursorY > 0) cursorY--; 
-                break;
-            case InputKey::DOWN:  
-                if (cursorY < boardSize - 1) cursorY++; 
-                break;
-            case InputKey::ENTER:
-            {
-                if (board->isValid(cursorX, cursorY, turn)) {
-                    board->put(cursorX, cursorY, turn);
-                    
-                    // Record the move
-                    MoveRecord move;
-                    move.row = cursorY;
-                    move.col = cursorX;
-                    move.player = turn;
-                    moveHistory.push_back(move);
-                    
-                    turn = opponent(turn);
-                }
-                break;
-            }
-            case InputKey::R:
-                resetGame();
-                break;
-            case InputKey::ESC:
-            case InputKey::Q:
-                isRunning = false;
-                break;
-            default:
-                break;
+        // Human to move against the computer: the engine thinks on their time.
+        // It works on its own copy of the board and is stopped when they move.
+        if (!engineTurn && isComputer(opponent(turn)) && hasMoves && !pondering) {
+            worker.ponder(*board, turn, engineLimits);
+            pondering = true;
         }
 
-        // if current player has no moves, pass turn
-        if (board->getValid(turn).empty()) {
-            turn = opponent(turn);
-            if (board->getValid(turn).empty()) {
-                // Game over
-                renderer.drawBoard(*board, {}, turn, cursorX, cursorY);
-                renderer.drawSideMenu(moveHistory, board->count(Board::Disk::X), board->count(Board::Disk::O), 
-                                     turn, cursorX, cursorY, getElapsedSeconds(), boardSize);
+        if (unsigned regions = frames.take(FrameScheduler::Clock::now())) {
+            draw(regions);
+            renderer.present();
+        }
+
+        keys.clear();
+        unsigned ready = events.wait(keys, frames.timeout(FrameScheduler::Clock::now()));
+        if (ready & EventLoop::TICK)
+            frames.mark(Renderer::CLOCK);
+        if (ready & EventLoop::RESIZE) {
+            renderer.resize();
+            frames.mark(Renderer::ALL);
+        }
+        for (const Key& k : keys) {
+            handleKey(k.key);
+            if (!isRunning) break;
+            settleTurn();
+        }
+    }
+
+    // Q / ESC during a search: it stops within a millisecond or so
+    stopEngine();
+    // Quitting mid-game: the time on the move being played counts when it
+    // is resumed (a finished game has its clocks in END already)
+    chargeClock(turn);
+    log.clocks(clockMs);
+    resetTextColor(); // frames leave the terminal in their last colour
+    showCursor();
+}
+
+void Game::draw(unsigned regions)
+{
+    regions = renderer.beginFrame(boardSize, regions);
+    if (regions & Renderer::BOARD)
+        renderer.drawBoard(*board, board->getValid(turn), turn, cursorX, cursorY);
+    renderer.drawSideMenu(moveHistory, board->count(Disk::X), board->count(Disk::O),
+                          turn, cursorX, cursorY, getElapsedSeconds(), boardSize, engineInfo(), regions);
+    if ((regions & Renderer::HISTORY) && db.isOpen())
+        renderer.drawDatabase(db.moveStats(*board, turn));
+}
+
+void Game::handleKey(InputKey key)
+{
+    switch (key) {
+        case InputKey::LEFT:  
+            if (cursorX > 0) cursorX--; 
+            frames.mark(Renderer::BOARD | Renderer::STATUS);
+            break;
+        case InputKey::RIGHT: 
+            if (cursorX < boardSize - 1) cursorX++; 
+            frames.mark(Renderer::BOARD | Renderer::STATUS);
+            break;
+        case InputKey::UP:    
+            if (cursorY > 0) cursorY--; 
+            frames.mark(Renderer::BOARD | Renderer::STATUS);
+            break;
+        case InputKey::DOWN:  
+            if (cursorY < boardSize - 1) cursorY++; 
+            frames.mark(Renderer::BOARD | Renderer::STATUS);
+            break;
+        case InputKey::ENTER:
+        {
+            if (!isComputer(turn) && board->isValid(cursorX, cursorY, turn)) {
+                if (pondering)
+                    worker.stop();
+                pondering = false;
+                board->put(cursorX, cursorY, turn);
                 
-                // Show game over message
-                // Display winner/tie message
-                isWinner(20,20);
-
-                move_cursor(4, 25);
-                setTextColor(TextColor::BRIGHT_WHITE);
-                cout << "Game over! Press Q to quit or R to restart.";
-                resetTextColor();
+                // Record the move
+                MoveRecord move;
+                move.row = cursorY;
+                move.col = cursorX;
+                move.player = turn;
+                moveHistory.push_back(move);
+                recordMove(turn, cursorY * boardSize + cursorX);
                 
-                while (true) {
-                    InputKey k = getInputKey();
-                    if (k == InputKey::Q || k == InputKey::ESC) {
-                        isRunning = false;
-                        break;
-                    } else if (k == InputKey::R) {
-                        resetGame();
-                        break;
-                    }
-                }
+                turn = opponent(turn);
+                frames.mark(MOVE_REGIONS);
             }
+            break;
         }
+        case InputKey::R:
+            resetGame();
+            break;
+        case InputKey::U:
+            undoMove();
+            break;
+        case InputKey::ESC:
+        case InputKey::Q:
+            isRunning = false;
+            break;
+        default:
+            break;
     }
+}
 
-    showCursor();
+void Game::settleTurn()
+{
+    // if current player has no moves, pass turn
+    if (!board->getValid(turn).empty())
+        return;
+    turn = opponent(turn);
+    frames.mark(Renderer::BOARD | Renderer::STATUS);
+    if (!board->getValid(turn).empty()) {
+        recordMove(opponent(turn), record::PASS);
+        return;
+    }
+
+    // Game over: the final position and the result until a key, laid out
+    // again if the terminal is resized meanwhile
+    auto drawGameOver = [&]() {
+        draw(Renderer::ALL);
+        const Layout& layout = renderer.layout();
+        isWinner(layout.messageX, layout.messageY);
+        renderer.drawText(layout.messageX, layout.messageY + 1, "Game over! Q quit, R restart, U undo.",
+                          TextColor::BRIGHT_WHITE);
+        renderer.present();
+    };
+    drawGameOver();
+
+    vector<Key> keys;
+    while (true) {
+        keys.clear();
+        if (events.wait(keys) & EventLoop::RESIZE) {
+            renderer.resize();
+            drawGameOver();
+        }
+        for (const Key& key : keys) {
+            if (key.key == InputKey::Q || key.key == InputKey::ESC) {
+                log.endGame(clockMs, board->count(Disk::X), board->count(Disk::O));
+                isRunning = false;
+                return;
+            } else if (key.key == InputKey::R) {
+                log.endGame(clockMs, board->count(Disk::X), board->count(Disk::O));
+                resetGame();
+                return;
+            } else if (key.key == InputKey::U) {
+                undoMove();
+                // The result lines are below every region undoMove marks
+                frames.mark(Renderer::ALL);
+                return;
+            }
+        }
+    }
 }
 
 void Game::showMenu()
@@ -181,42 +244,294 @@ void Game::showMenu()
     cout << flush;
 
     while (true) {
-        // Non-blocking check for number or quit keys
-        if (kbhit()) {
-            int ch = getch();
-            if (ch == '1') {
-                boardSize = 8;
-                board = new Board(8, true);
-                return;
-            } else if (ch == '2') {
-                boardSize = 10;
-                board = new Board(10, true);
-                return;
-            } else if (ch == '3') {
-                boardSize = 12;
-                board = new Board(12, true);
-                return;
-            } else if (ch == 'q' || ch == 'Q' || ch == 27) {
-                board = nullptr;
-                isRunning = false;
+        Key key = events.waitKey();
+        char ch = key.ch;
+        if (ch == '1' || ch == '2' || ch == '3') {
+            boardSize = ch == '1' ? 8 : ch == '2' ? 10 : 12;
+            if (!choosePlayers()) {
+                showMenu(); // back to the size selection
                 return;
             }
+            board = new AnyBoard(boardSize);
+            resetGame();
+            return;
+        } else if (key.key == InputKey::Q || key.key == InputKey::ESC) {
+            board = nullptr;
+            isRunning = false;
+            return;
+        }
+    }
+}
+
+bool Game::choosePlayers()
+{
+    move_cursor(20, 10);
+    setTextColor(TextColor::WHITE);
+    cout << "╔══════════════════════════════════════╗";
+    move_cursor(20, 11);
+    cout << "║            SELECT PLAYERS            ║";
+    move_cursor(20, 12);
+    cout << "╠══════════════════════════════════════╣";
+    move_cursor(20, 13);
+    cout << "║  1. Human " << BLACK_CIRCLE << "    vs  Human " << WHITE_CIRCLE << "           ║";
+    move_cursor(20, 14);
+    cout << "║  2. Human " << BLACK_CIRCLE << "    vs  Computer " << WHITE_CIRCLE << "        ║";
+    move_cursor(20, 15);
+    cout << "║  3. Computer " << BLACK_CIRCLE << " vs  Human " << WHITE_CIRCLE << "           ║";
+    move_cursor(20, 16);
+    cout << "║  4. Computer " << BLACK_CIRCLE << " vs  Computer " << WHITE_CIRCLE << "        ║";
+    move_cursor(20, 17);
+    cout << "║  Q. Back                             ║";
+    move_cursor(20, 18);
+    cout << "╚══════════════════════════════════════╝";
+    resetTextColor();
+    cout << flush;
+
+    while (true) {
+        Key key = events.waitKey();
+        char ch = key.ch;
+        if (ch >= '1' && ch <= '4') {
+            computerPlays[0] = ch == '3' || ch == '4';
+            computerPlays[1] = ch == '2' || ch == '4';
+            return true;
+        } else if (key.key == InputKey::Q || key.key == InputKey::ESC) {
+            return false;
         }
-        // small sleep to avoid busy loop
-        sleep_ms(50);
     }
 }
 
+void Game::pollEngine()
+{
+    EngineWorker::Response r;
+    while (worker.poll(r)) {
+        if (r.id != searchId)
+            continue; // left over from a search that was stopped
+        if (r.type == EngineWorker::Response::PROGRESS) {
+            thinking = r.progress;
+            frames.mark(Renderer::STATUS);
+            continue;
+        }
+        searchId = 0;
+        frames.mark(Renderer::STATUS);
+        if (!r.cancelled)
+            playEngineMove(r.result);
+    }
+}
+
+void Game::playEngineMove(const SearchResult& result)
+{
+    lastSearch = result;
+    lastSearchSide = turn;
+    if (lastSearch.move < 0)
+        return;
+
+    MoveRecord move;
+    move.row = lastSearch.move / boardSize;
+    move.col = lastSearch.move % boardSize;
+    move.player = turn;
+    board->put(move.col, move.row, turn);
+    moveHistory.push_back(move);
+    recordMove(turn, lastSearch.move);
+    turn = opponent(turn);
+    frames.mark(MOVE_REGIONS);
+}
+
+// Stops the search or ponder in progress and forgets its result.
+void Game::stopEngine()
+{
+    worker.stop();
+    searchId = 0;
+    pondering = false;
+    frames.mark(Renderer::STATUS);
+}
+
+string Game::engineInfo() const
+{
+    if (!computerPlays[0] && !computerPlays[1])
+        return "";
+
+    ostringstream out;
+    if (searchId) {
+        // Live line: depth (or win rate), nodes, and as much of the PV as fits
+        const size_t width = 39;
+        out << "Thinking: ";
+        if (thinking.winRate >= 0)
+            out << fixed << setprecision(0) << thinking.winRate * 100 << "% win, ";
+        else
+            out << "d" << thinking.depth << ", ";
+        if (thinking.nodes >= 1000000)
+            out << fixed << setprecision(2) << thinking.nodes / 1e6 << "M";
+        else if (thinking.nodes >= 1000)
+            out << thinking.nodes / 1000 << "k";
+        else
+            out << thinking.nodes;
+        out << (thinking.winRate >= 0 ? " playouts" : " nodes");
+        string line = out.str();
+        for (size_t i = 0; i < thinking.pv.size(); i++) {
+            int sq = thinking.pv[i];
+            string m = sq < 0 ? "--" : string(1, (char)('A' + sq % boardSize)) + to_string(sq / boardSize + 1);
+            string sep = i == 0 ? ", " : " ";
+            if (line.size() + sep.size() + m.size() > width)
+                break;
+            line += sep + m;
+        }
+        return line;
+    }
+    if (lastSearch.book) {
+        out << "Computer: book move, d" << lastSearch.depth;
+        return out.str();
+    }
+    if (lastSearch.depth == 0 && lastSearch.nodes == 0)
+        return "Computer ready";
+
+    if (lastSearch.exact) {
+        // Solved to the end: show the outcome of perfect play
+        int diffX = discDifference(lastSearch.score) * (lastSearchSide == Disk::X ? 1 : -1);
+        if (diffX == 0)
+            out << "Solved: draw with best play";
+        else
+            out << "Solved: " << (diffX > 0 ? BLACK_CIRCLE : WHITE_CIRCLE) << " wins by " << abs(diffX);
+        return out.str();
+    }
+    if (lastSearch.winRate >= 0) {
+        out << "MCTS: ";
+        if (lastSearch.pondered)
+            out << "from ponder";
+        else
+            out << fixed << setprecision(2) << lastSearch.nps() / 1e6 << "M playouts/s";
+        out << ", win " << fixed << setprecision(0) << lastSearch.winRate * 100 << "%";
+        return out.str();
+    }
+    if (lastSearch.pondered) {
+        out << "Computer: d" << lastSearch.depth << " from ponder";
+        return out.str();
+    }
+    out << "Computer: d" << lastSearch.depth << ", " << fixed << setprecision(1)
+        << lastSearch.nps() / 1e6 << "M n/s, TT " << setprecision(0)
+        << lastSearch.ttHitRate() * 100 << "%";
+    return out.str();
+}
+
 void Game::resetGame()
+{
+    clearGame();
+    if (log.isOpen())
+        log.beginGame(boardSize, (computerPlays[0] ? 1 : 0) | (computerPlays[1] ? 2 : 0));
+}
+
+// The starting position with clocks at zero and a fresh engine
+void Game::clearGame()
 {
     if (board) {
         board->reset();
     }
-    turn = Board::Disk::X;
+    turn = Disk::X;
     cursorX = 0;
     cursorY = 0;
     moveHistory.clear();
+    lastSearch = SearchResult();
+    stopEngine();
+    worker.call([](Engine& e) { e.newGame(); });
     startTime = std::chrono::steady_clock::now();
+    turnStart = startTime;
+    clockMs[0] = clockMs[1] = 0;
+    events.startClock(startTime);
+    frames.mark(Renderer::ALL);
+}
+
+// Continues the game left in progress in the record (by quitting or a
+// crash), without the menus. Replaying it is one put() per recorded move.
+bool Game::resumeGame()
+{
+    const GameRecord* game = log.unfinished();
+    if (!game)
+        return false;
+    boardSize = game->boardSize;
+    computerPlays[0] = game->players & 1;
+    computerPlays[1] = game->players & 2;
+    board = new AnyBoard(boardSize);
+    clearGame();
+
+    for (uint8_t m : game->moves) {
+        if (m == record::PASS) {
+            turn = opponent(turn);
+            continue;
+        }
+        int x = m % boardSize, y = m / boardSize;
+        if (!board->isValid(x, y, turn)) {
+            // Not a game this board can replay: start a new one instead
+            resetGame();
+            return true;
+        }
+        board->put(x, y, turn);
+        moveHistory.push_back({ y, x, turn });
+        turn = opponent(turn);
+        cursorX = x;
+        cursorY = y;
+    }
+
+    // The clocks as recorded, and the elapsed time on the side menu with them
+    clockMs[0] = game->clockMs[0];
+    clockMs[1] = game->clockMs[1];
+    startTime = turnStart - std::chrono::milliseconds((uint64_t)clockMs[0] + clockMs[1]);
+    events.startClock(startTime);
+    return true;
+}
+
+// The computer's limits for this move. Each side's clock holds an allowance
+// of engineLimits.seconds for each of its moves in a game (about 30 on 8x8),
+// and a move gets its share of what is left on the side's clock, so a side
+// that has been slow (or a game resumed with its clocks) thinks faster.
+SearchLimits Game::moveLimits() const
+{
+    int squares = boardSize * boardSize;
+    double allowance = engineLimits.seconds * (squares - 4) / 2;
+    double used = clockMs[turn == Disk::X ? 0 : 1] / 1000.0 +
+                  std::chrono::duration<double>(std::chrono::steady_clock::now() - turnStart).count();
+    SearchLimits limits = engineLimits;
+    limits.seconds = moveBudget(allowance - used, 0, board->count(Disk::Empty));
+    return limits;
+}
+
+// Charges the time since the last move to `side`.
+void Game::chargeClock(Disk side)
+{
+    auto now = std::chrono::steady_clock::now();
+    clockMs[side == Disk::X ? 0 : 1] += (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(now - turnStart).count();
+    turnStart = now;
+}
+
+// Charges the time since the last move to `side` and appends the move. Every
+// CLOCK_MOVES moves the clocks follow, so that a crash loses at most that
+// many moves' time.
+void Game::recordMove(Disk side, int square)
+{
+    chargeClock(side);
+    log.move(square);
+    if (square != record::PASS && moveHistory.size() % record::CLOCK_MOVES == 0)
+        log.clocks(clockMs);
+}
+
+void Game::undoMove()
+{
+    if (!board || moveHistory.empty())
+        return;
+    stopEngine();
+    if (!board->undo())
+        return;
+    log.undo();
+
+    // Passes are not recorded, so the turn goes back to whoever made the move.
+    const MoveRecord& last = moveHistory.back();
+    turn = last.player;
+    cursorX = last.col;
+    cursorY = last.row;
+    moveHistory.pop_back();
+    frames.mark(MOVE_REGIONS);
+
+    // Against the computer, keep taking moves back until it is the human's turn
+    if (isComputer(turn) && !(computerPlays[0] && computerPlays[1]))
+        undoMove();
 }
 
 int Game::getElapsedSeconds() const
@@ -229,12 +544,14 @@ int Game::getElapsedSeconds() const
 void Game::isWinner(int posX, int posY) {
     // Determine winner based on current board counts
     if (!board) return;
-    int countX = board->count(Board::Disk::X);
-    int countO = board->count(Board::Disk::O);
+    // Exact result with perfect play from here; at the end of the game this is
+    // simply the final disc count.
+    int diffX = 0;
+    worker.call([&](Engine& e) { diffX = e.solve(*board, Disk::X).diff; });
 
     string msg;
-    if (countX > countO) msg = string("Player ") + BLACK_CIRCLE + " wins!";
-    else if (countO > countX) msg = string("Player ") + WHITE_CIRCLE + " wins!";
+    if (diffX > 0) msg = string("Player ") + BLACK_CIRCLE + " wins!";
+    else if (diffX < 0) msg = string("Player ") + WHITE_CIRCLE + " wins!";
     else msg = "It's a tie!";
 
     int cx = posX;
@@ -249,13 +566,7 @@ void Game::isWinner(int posX, int posY) {
         }
     }
 
-    move_cursor(max(1, cx), max(1, cy));
-    setTextColor(TextColor::BRIGHT_GREEN);
-    cout << msg;
-    resetTextColor();
-    cout << flush;
-    // pause so the player sees the message
-    this_thread::sleep_for(chrono::seconds(3));
+    renderer.drawText(max(1, cx), max(1, cy), msg, TextColor::BRIGHT_GREEN);
 }
 
 
@@ -0,0 +1,475 @@
+#include "game_db.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "file_io.hpp"
+#include "game_record.hpp"
+#include "symmetry.hpp"
+
+using namespace std;
+
+namespace {
+
+const char MAGIC[8] = { 'O', 'T', 'H', 'D', 'B', '1', 0, 0 };
+
+struct DbHeader {
+    char magic[8];
+    uint64_t games;
+    uint64_t positions;
+    uint64_t reserved[5];
+};
+
+struct DbPartition {
+    uint64_t offset;    // of the table from the start of the file
+    uint64_t capacity;  // slots, a power of two (0: empty partition)
+};
+
+constexpr size_t DIRECTORY_END = sizeof(DbHeader) + GameDb::PARTITIONS * sizeof(DbPartition);
+
+int partitionOf(uint64_t key)
+{
+    return (int)(key >> (64 - GameDb::PARTITION_BITS));
+}
+
+// WTHOR archive: a 16-byte header (the game count at offset 4, the board size
+// at 12), then 68 bytes per game: tournament, players, black's final score,
+// theoretical score and 60 moves as 10 * row + column from 11, 0 after the
+// last one. Passes are not recorded.
+constexpr size_t WTHOR_HEADER = 16;
+constexpr size_t WTHOR_GAME = 68;
+
+// X's points from a final score: 2 for a win, 1 for a draw
+uint32_t pointsFor(int discsX, int discsO)
+{
+    return discsX > discsO ? 2 : discsX == discsO ? 1 : 0;
+}
+
+struct Occurrence {
+    uint64_t key;
+    uint32_t points;
+};
+
+// One partition while building: an open-addressing table grown at 70% load.
+// Workers merge buffers into it under its lock.
+struct BuildTable {
+    mutex lock;
+    vector<DbSlot> slots;
+    size_t used = 0;
+
+    void insert(uint64_t key, uint32_t games, uint32_t points)
+    {
+        size_t mask = slots.size() - 1;
+        for (size_t i = key & mask;; i = (i + 1) & mask) {
+            DbSlot& s = slots[i];
+            if (s.key == key) {
+                s.games += games;
+                s.points += points;
+                return;
+            }
+            if (s.key == 0) {
+                s = { key, games, points };
+                used++;
+                return;
+            }
+        }
+    }
+
+    void merge(const Occurrence* o, size_t n)
+    {
+        lock_guard<mutex> hold(lock);
+        for (size_t i = 0; i < n; i++) {
+            if ((used + 1) * 10 > slots.size() * 7)
+                grow();
+            insert(o[i].key, 1, o[i].points);
+        }
+    }
+
+    void grow()
+    {
+        vector<DbSlot> old(max<size_t>(1024, slots.size() * 2), DbSlot{ 0, 0, 0 });
+        old.swap(slots);
+        used = 0;
+        for (const DbSlot& s : old)
+            if (s.key)
+                insert(s.key, s.games, s.points);
+    }
+};
+
+// A run of whole games in one mapped input
+struct Job {
+    const uint8_t* data;
+    size_t size;
+    bool wthor;
+};
+
+struct Mapping {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    ~Mapping() { if (data) munmap((void*)data, size); }
+};
+
+class Builder {
+public:
+    explicit Builder(BuildTable* tables) : tables(tables) {}
+
+    void run(const Job& job)
+    {
+        if (job.wthor) {
+            for (size_t at = 0; at + WTHOR_GAME <= job.size; at += WTHOR_GAME)
+                wthorGame(job.data + at);
+        } else {
+            GameLogReader reader(job.data, job.size, 0);
+            GameRecord game;
+            while (reader.next(game))
+                logGame(game);
+            if (reader.error())
+                skipped++;
+        }
+    }
+
+    // Whatever is still buffered, and the counts
+    void finish(atomic<uint64_t>& games, atomic<uint64_t>& positions, atomic<uint64_t>& skips)
+    {
+        for (int p = 0; p < GameDb::PARTITIONS; p++) {
+            tables[p].merge(buffers[p].data(), buffers[p].size());
+            buffers[p].clear();
+        }
+        publish(games, positions, skips);
+    }
+
+    void publish(atomic<uint64_t>& games, atomic<uint64_t>& positions, atomic<uint64_t>& skips)
+    {
+        games += played;
+        positions += replayed;
+        skips += skipped;
+        played = replayed = skipped = 0;
+    }
+
+private:
+    static constexpr size_t FLUSH = 2048;
+
+    BuildTable* tables;
+    vector<Occurrence> buffers[GameDb::PARTITIONS];
+    uint64_t keys[144];
+    uint64_t played = 0, replayed = 0, skipped = 0;
+
+    void emit(int count, uint32_t points)
+    {
+        for (int i = 0; i < count; i++) {
+            vector<Occurrence>& buf = buffers[partitionOf(keys[i])];
+            buf.push_back({ keys[i], points });
+            if (buf.size() >= FLUSH) {
+                tables[partitionOf(keys[i])].merge(buf.data(), buf.size());
+                buf.clear();
+            }
+        }
+        played++;
+        replayed += count;
+    }
+
+    void wthorGame(const uint8_t* rec)
+    {
+        Board<8> b;
+        Disk side = Disk::X;
+        int count = 0;
+        for (int i = 0; i < 60 && rec[8 + i]; i++) {
+            int m = rec[8 + i], row = m / 10 - 1, col = m % 10 - 1;
+            int sq = row * 8 + col;
+            if (row < 0 || row > 7 || col < 0 || col > 7) {
+                skipped++;
+                return;
+            }
+            if (!bitboard::test(b.moves(side), sq)) {
+                side = opponent(side);  // a pass
+                if (!bitboard::test(b.moves(side), sq)) {
+                    skipped++;
+                    return;
+                }
+            }
+            b.play(sq, side);
+            keys[count++] = symmetry::canonicalKey(b, side);
+            side = opponent(side);
+        }
+        // Black's score counts the empty squares for the winner, as WTHOR does
+        emit(count, pointsFor(rec[6], 64 - rec[6]));
+    }
+
+    void logGame(const GameRecord& game)
+    {
+        if (game.status != GameRecord::FINISHED) {
+            skipped++;
+            return;
+        }
+        int count = -1;
+        switch (game.boardSize) {
+            case 8: count = replay<8>(game); break;
+            case 10: count = replay<10>(game); break;
+            case 12: count = replay<12>(game); break;
+        }
+        if (count < 0) {
+            skipped++;
+            return;
+        }
+        emit(count, pointsFor(game.discs[0], game.discs[1]));
+    }
+
+    template <int N>
+    int replay(const GameRecord& game)
+    {
+        Board<N> b;
+        Disk side = Disk::X;
+        int count = 0;
+        for (uint8_t m : game.moves) {
+            if (m != record::PASS) {
+                if (count == N * N || !bitboard::test(b.moves(side), m))
+                    return -1;
+                b.play(m, side);
+                keys[count++] = symmetry::canonicalKey(b, side);
+            }
+            side = opponent(side);
+        }
+        return count;
+    }
+};
+
+// Cuts a mapped input into jobs of about a megabyte of whole games.
+bool planJobs(const Mapping& in, vector<Job>& jobs)
+{
+    constexpr size_t JOB_BYTES = 1 << 20;
+    if (GameLogReader::hasMagic(in.data, in.size)) {
+        size_t at = record::MAGIC_SIZE;
+        while (at < in.size) {
+            // Jobs start at a game: START is the only byte with its value
+            size_t end = min(in.size, at + JOB_BYTES);
+            while (end < in.size && in.data[end] != record::START)
+                end++;
+            jobs.push_back({ in.data + at, end - at, false });
+            at = end;
+        }
+        return true;
+    }
+
+    if (in.size < WTHOR_HEADER)
+        return false;
+    uint32_t count;
+    memcpy(&count, in.data + 4, sizeof count);
+    int size = in.data[12];
+    if ((size != 0 && size != 8) || in.size < WTHOR_HEADER + (size_t)count * WTHOR_GAME)
+        return false;
+    size_t bytes = (size_t)count * WTHOR_GAME;
+    size_t step = JOB_BYTES / WTHOR_GAME * WTHOR_GAME;
+    for (size_t at = 0; at < bytes; at += step)
+        jobs.push_back({ in.data + WTHOR_HEADER + at, min(step, bytes - at), true });
+    return true;
+}
+
+} // namespace
+
+GameDb::~GameDb()
+{
+    close();
+}
+
+bool GameDb::open(const string& path, string* error)
+{
+    auto fail = [&](const char* why) {
+        if (error) *error = path + ": " + why;
+        close();
+        return false;
+    };
+
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return fail(strerror(errno));
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < DIRECTORY_END) {
+        ::close(fd);
+        return fail("not a game database");
+    }
+    void* map = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+        return fail(strerror(errno));
+    base = static_cast<const uint8_t*>(map);
+    length = (size_t)st.st_size;
+
+    if (memcmp(base, MAGIC, sizeof MAGIC) != 0)
+        return fail("not a game database");
+    const DbPartition* dir = reinterpret_cast<const DbPartition*>(base + sizeof(DbHeader));
+    for (int p = 0; p < PARTITIONS; p++) {
+        uint64_t cap = dir[p].capacity;
+        if ((cap & (cap - 1)) != 0 || dir[p].offset > length || cap * sizeof(DbSlot) > length - dir[p].offset)
+            return fail("database is damaged");
+    }
+    return true;
+}
+
+void GameDb::close()
+{
+    if (base)
+        munmap((void*)base, length);
+    base = nullptr;
+    length = 0;
+}
+
+const DbSlot* GameDb::find(uint64_t key) const
+{
+    if (!base)
+        return nullptr;
+    const DbPartition& part = reinterpret_cast<const DbPartition*>(base + sizeof(DbHeader))[partitionOf(key)];
+    if (!part.capacity)
+        return nullptr;
+    const DbSlot* table = reinterpret_cast<const DbSlot*>(base + part.offset);
+    size_t mask = part.capacity - 1;
+    // A sound table always has an empty slot; a damaged one may not
+    for (size_t i = key & mask, probes = 0; probes < part.capacity; i = (i + 1) & mask, probes++) {
+        if (table[i].key == key)
+            return &table[i];
+        if (table[i].key == 0)
+            return nullptr;
+    }
+    return nullptr;
+}
+
+vector<MoveStats> GameDb::moveStats(const AnyBoard& board, Disk side) const
+{
+    vector<MoveStats> out;
+    if (!base)
+        return out;
+    board.visit([&](const auto& b) {
+        using B = std::decay_t<decltype(b)>;
+        constexpr int N = B::SIZE;
+        for (auto m = b.moves(side); bitboard::any(m); ) {
+            int sq = bitboard::popLowest(m);
+            B child = b;
+            child.play(sq, side);
+            const DbSlot* s = find(symmetry::canonicalKey(child, side));
+            if (!s)
+                continue;
+            double score = s->points / (2.0 * s->games);
+            out.push_back({ sq % N, sq / N, s->games, side == Disk::X ? score : 1 - score });
+        }
+    });
+    sort(out.begin(), out.end(), [](const MoveStats& a, const MoveStats& b) { return a.games > b.games; });
+    return out;
+}
+
+uint64_t GameDb::games() const
+{
+    return base ? reinterpret_cast<const DbHeader*>(base)->games : 0;
+}
+
+uint64_t GameDb::positions() const
+{
+    return base ? reinterpret_cast<const DbHeader*>(base)->positions : 0;
+}
+
+bool buildGameDb(const vector<string>& inputs, const string& output, int threads,
+                 DbBuildStats& stats, string* error, const function<void(const DbBuildStats&)>& progress)
+{
+    auto fail = [&](const string& why) {
+        if (error) *error = why;
+        return false;
+    };
+    auto start = chrono::steady_clock::now();
+    stats = DbBuildStats();
+
+    vector<Mapping> maps(inputs.size());
+    vector<Job> jobs;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        int fd = ::open(inputs[i].c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            if (fd >= 0) ::close(fd);
+            return fail(inputs[i] + ": " + strerror(errno));
+        }
+        if (st.st_size > 0) {
+            void* map = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+                maps[i].data = static_cast<const uint8_t*>(map);
+                maps[i].size = (size_t)st.st_size;
+            }
+        }
+        ::close(fd);
+        if (!maps[i].data || !planJobs(maps[i], jobs))
+            return fail(inputs[i] + ": not a WTHOR archive or game log");
+    }
+
+    // Replay: workers take jobs in turn
+    unique_ptr<BuildTable[]> tables(new BuildTable[GameDb::PARTITIONS]);
+    atomic<size_t> nextJob{ 0 };
+    atomic<uint64_t> games{ 0 }, positions{ 0 }, skipped{ 0 };
+    auto work = [&](int id) {
+        Builder builder(tables.get());
+        auto lastReport = chrono::steady_clock::now();
+        for (size_t j; (j = nextJob++) < jobs.size(); ) {
+            builder.run(jobs[j]);
+            builder.publish(games, positions, skipped);
+            auto now = chrono::steady_clock::now();
+            if (id == 0 && progress && now - lastReport >= chrono::seconds(1)) {
+                lastReport = now;
+                DbBuildStats snapshot;
+                snapshot.games = games;
+                snapshot.positions = positions;
+                snapshot.skipped = skipped;
+                snapshot.seconds = chrono::duration<double>(now - start).count();
+                progress(snapshot);
+            }
+        }
+        builder.finish(games, positions, skipped);
+    };
+    threads = max(1, threads);
+    vector<thread> pool;
+    for (int t = 1; t < threads; t++)
+        pool.emplace_back(work, t);
+    work(0);
+    for (thread& t : pool)
+        t.join();
+
+    // Write the tables behind their directory, then put the file in place
+    DbHeader header = {};
+    memcpy(header.magic, MAGIC, sizeof MAGIC);
+    header.games = games;
+    vector<DbPartition> dir(GameDb::PARTITIONS);
+    uint64_t offset = DIRECTORY_END;
+    for (int p = 0; p < GameDb::PARTITIONS; p++) {
+        dir[p] = { offset, tables[p].slots.size() };
+        offset += tables[p].slots.size() * sizeof(DbSlot);
+        header.positions += tables[p].used;
+    }
+
+    string temp = output + ".tmp";
+    int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return fail(temp + ": " + strerror(errno));
+    bool ok = writeAll(fd, &header, sizeof header) && writeAll(fd, dir.data(), dir.size() * sizeof(DbPartition));
+    for (int p = 0; ok && p < GameDb::PARTITIONS; p++)
+        ok = writeAll(fd, tables[p].slots.data(), tables[p].slots.size() * sizeof(DbSlot));
+    ok = ok && fdatasync(fd) == 0;
+    ::close(fd);
+    if (!ok || rename(temp.c_str(), output.c_str()) != 0) {
+        unlink(temp.c_str());
+        return fail(output + ": " + strerror(errno));
+    }
+
+    stats.games = header.games;
+    stats.positions = positions;
+    stats.distinct = header.positions;
+    stats.skipped = skipped;
+    stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return true;
+}
@@ -0,0 +1,336 @@
+#include "game_record.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace record;
+
+static const char MAGIC[MAGIC_SIZE] = { 'O', 'T', 'H', 'L', 'O', 'G', '1', '\n' };
+
+// Clocks are written in 7-bit bytes so that no payload byte looks like a tag
+static void putClock(uint8_t* out, uint32_t ms)
+{
+    for (int i = 0; i < 5; i++, ms >>= 7)
+        out[i] = ms & 0x7F;
+}
+
+static uint32_t getClock(const uint8_t* in)
+{
+    uint32_t ms = 0;
+    for (int i = 4; i >= 0; i--)
+        ms = ms << 7 | in[i];
+    return ms;
+}
+
+bool GameLogReader::hasMagic(const uint8_t* data, size_t size)
+{
+    return size >= MAGIC_SIZE && memcmp(data, MAGIC, MAGIC_SIZE) == 0;
+}
+
+bool GameLogReader::next(GameRecord& game)
+{
+    failure = nullptr;
+    if (pos >= size)
+        return false;
+    if (size - pos < START_SIZE || data[pos] != START) {
+        failure = "expected the start of a game";
+        return false;
+    }
+    int n = data[pos + 1];
+    if ((n != 8 && n != 10 && n != 12) || data[pos + 2] > 3) {
+        failure = "bad game header";
+        return false;
+    }
+    game.boardSize = n;
+    game.players = data[pos + 2];
+    game.moves.clear();
+    game.status = GameRecord::PLAYING;
+    game.clockMs[0] = game.clockMs[1] = 0;
+    game.discs[0] = game.discs[1] = 0;
+    pos += START_SIZE;
+
+    int squares = n * n;
+    while (pos < size) {
+        // A run of plain moves is copied in one go
+        size_t run = pos;
+        while (run < size && (data[run] < squares || data[run] == PASS))
+            run++;
+        game.moves.insert(game.moves.end(), data + pos, data + run);
+        pos = run;
+        if (pos == size)
+            break;
+
+        uint8_t tag = data[pos];
+        if (tag == UNDO) {
+            while (!game.moves.empty() && game.moves.back() == PASS)
+                game.moves.pop_back();
+            if (!game.moves.empty())
+                game.moves.pop_back();
+            pos++;
+        } else if (tag == END) {
+            if (size - pos < END_SIZE) {
+                failure = "end of game is cut off";
+                return false;
+            }
+            const uint8_t* p = data + pos + 1;
+            game.clockMs[0] = getClock(p);
+            game.clockMs[1] = getClock(p + 5);
+            game.discs[0] = p[10];
+            game.discs[1] = p[11];
+            game.status = GameRecord::FINISHED;
+            pos += END_SIZE;
+            return true;
+        } else if (tag == CLOCK) {
+            if (size - pos < CLOCK_SIZE) {
+                failure = "clocks are cut off";
+                return false;
+            }
+            game.clockMs[0] = getClock(data + pos + 1);
+            game.clockMs[1] = getClock(data + pos + 6);
+            pos += CLOCK_SIZE;
+        } else if (tag == ABANDON) {
+            game.status = GameRecord::ABANDONED;
+            pos++;
+            return true;
+        } else if (tag == START) {
+            return true; // never finished: left as PLAYING
+        } else {
+            failure = "bad move";
+            return false;
+        }
+    }
+    return true; // the game in progress at the end of the log
+}
+
+GameLog::~GameLog()
+{
+    close();
+}
+
+bool GameLog::open(const string& path, string* error)
+{
+    auto fail = [&](const char* why) {
+        if (error) *error = path + ": " + why;
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+        return false;
+    };
+
+    close();
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return fail(strerror(errno));
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+        return fail(strerror(errno));
+    if (st.st_size == 0) {
+        if (write(fd, MAGIC, MAGIC_SIZE) != (ssize_t)MAGIC_SIZE)
+            return fail(strerror(errno));
+    } else {
+        uint8_t magic[MAGIC_SIZE];
+        if (pread(fd, magic, MAGIC_SIZE, 0) != (ssize_t)MAGIC_SIZE || !GameLogReader::hasMagic(magic, MAGIC_SIZE))
+            return fail("not a game log");
+    }
+    if (!recover())
+        return fail("cannot read the log");
+    lastSync = chrono::steady_clock::now();
+    return true;
+}
+
+// Walks back from the end of the file to the last tag that starts or ends a
+// game: a complete game leaves nothing to do, one in progress is loaded, and
+// a record cut short by a crash is truncated away.
+bool GameLog::recover()
+{
+    inGame = resumable = false;
+    while (true) {
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+            return false;
+        off_t end = st.st_size;
+
+        off_t found = -1;
+        uint8_t tag = 0;
+        uint8_t chunk[4096];
+        for (off_t p = end; p > (off_t)MAGIC_SIZE && found < 0;) {
+            size_t n = (size_t)min<off_t>(sizeof chunk, p - (off_t)MAGIC_SIZE);
+            p -= n;
+            if (pread(fd, chunk, n, p) != (ssize_t)n)
+                return false;
+            for (size_t i = n; i-- > 0;) {
+                if (chunk[i] == START || chunk[i] == END || chunk[i] == ABANDON) {
+                    found = p + i;
+                    tag = chunk[i];
+                    break;
+                }
+            }
+        }
+
+        if (found < 0) // moves without a game: nothing to keep
+            return end == (off_t)MAGIC_SIZE || ftruncate(fd, MAGIC_SIZE) == 0;
+        if (tag == ABANDON)
+            return end == found + 1 || ftruncate(fd, found + 1) == 0;
+        if (tag == END) {
+            if (end - found >= (off_t)END_SIZE)
+                return end == found + (off_t)END_SIZE || ftruncate(fd, found + END_SIZE) == 0;
+            // The end of the game was cut off: it is in progress again
+            if (ftruncate(fd, found) != 0)
+                return false;
+            continue;
+        }
+
+        // START: the game in progress, or a header cut off before any move
+        vector<uint8_t> bytes((size_t)(end - found));
+        if (pread(fd, bytes.data(), bytes.size(), found) != (ssize_t)bytes.size())
+            return false;
+        GameLogReader reader(bytes.data(), bytes.size(), 0);
+        if (!reader.next(resumed) || reader.offset() != bytes.size()) {
+            // Keep the moves up to the first byte that makes no sense
+            if (ftruncate(fd, found + (off_t)reader.offset()) != 0)
+                return false;
+            continue;
+        }
+        inGame = resumable = true;
+        return true;
+    }
+}
+
+void GameLog::close()
+{
+    if (fd < 0)
+        return;
+    sync();
+    ::close(fd);
+    fd = -1;
+    inGame = resumable = false;
+}
+
+void GameLog::setBatch(size_t bytes, double syncSeconds)
+{
+    batchBytes = bytes;
+    syncInterval = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(syncSeconds));
+    buffer.reserve(bytes + END_SIZE);
+}
+
+void GameLog::beginGame(int boardSize, uint8_t players)
+{
+    if (inGame)
+        abandonGame();
+    uint8_t bytes[START_SIZE] = { START, (uint8_t)boardSize, players };
+    append(bytes, sizeof bytes);
+    inGame = true;
+    resumable = false;
+}
+
+void GameLog::move(int square)
+{
+    uint8_t b = (uint8_t)square;
+    append(&b, 1);
+}
+
+void GameLog::clocks(const uint32_t clockMs[2])
+{
+    if (!inGame)
+        return;
+    uint8_t bytes[CLOCK_SIZE];
+    bytes[0] = CLOCK;
+    putClock(bytes + 1, clockMs[0]);
+    putClock(bytes + 6, clockMs[1]);
+    append(bytes, sizeof bytes);
+}
+
+void GameLog::undo()
+{
+    append(&UNDO, 1);
+}
+
+void GameLog::endGame(const uint32_t clockMs[2], int discsX, int discsO)
+{
+    uint8_t bytes[END_SIZE];
+    bytes[0] = END;
+    putClock(bytes + 1, clockMs[0]);
+    putClock(bytes + 6, clockMs[1]);
+    bytes[11] = (uint8_t)discsX;
+    bytes[12] = (uint8_t)discsO;
+    append(bytes, sizeof bytes);
+    inGame = resumable = false;
+}
+
+void GameLog::abandonGame()
+{
+    append(&ABANDON, 1);
+    inGame = resumable = false;
+}
+
+void GameLog::appendGame(const GameRecord& game)
+{
+    if (inGame)
+        abandonGame();
+    // At most a pass between two moves on the largest board
+    uint8_t bytes[START_SIZE + 2 * 144 + END_SIZE];
+    size_t n = game.moves.size();
+    if (n > 2 * 144)
+        return;
+    bytes[0] = START;
+    bytes[1] = (uint8_t)game.boardSize;
+    bytes[2] = game.players;
+    memcpy(bytes + START_SIZE, game.moves.data(), n);
+    uint8_t* end = bytes + START_SIZE + n;
+    if (game.status != GameRecord::FINISHED) {
+        // Stopped before the end (e.g. lost on time)
+        end[0] = ABANDON;
+        append(bytes, START_SIZE + n + 1);
+        resumable = false;
+        return;
+    }
+    end[0] = END;
+    putClock(end + 1, game.clockMs[0]);
+    putClock(end + 6, game.clockMs[1]);
+    end[11] = (uint8_t)game.discs[0];
+    end[12] = (uint8_t)game.discs[1];
+    append(bytes, START_SIZE + n + END_SIZE);
+    resumable = false;
+}
+
+void GameLog::append(const uint8_t* bytes, size_t n)
+{
+    if (fd < 0)
+        return;
+    buffer.insert(buffer.end(), bytes, bytes + n);
+    if (buffer.size() >= batchBytes)
+        flush();
+    if (unsynced && chrono::steady_clock::now() - lastSync >= syncInterval)
+        sync();
+}
+
+void GameLog::flush()
+{
+    size_t done = 0;
+    while (fd >= 0 && done < buffer.size()) {
+        ssize_t n = write(fd, buffer.data() + done, buffer.size() - done);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            break; // disk full or the like: the rest stays buffered
+        }
+        done += (size_t)n;
+    }
+    buffer.erase(buffer.begin(), buffer.begin() + done);
+    unsynced |= done > 0;
+}
+
+void GameLog::sync()
+{
+    flush();
+    if (fd >= 0 && unsynced)
+        fdatasync(fd);
+    unsynced = false;
+    lastSync = chrono::steady_clock::now();
+}
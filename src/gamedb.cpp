@@ -0,0 +1,167 @@
+// gamedb: builds and queries the position database the game shows with --db.
+//
+//   gamedb build DB [--threads T] FILE...    WTHOR archives (.wtb) and game logs
+//   gamedb query DB [--size N] [MOVES]       e.g. f5d6c3; passes are implied
+//   gamedb info DB
+//   gamedb verify
+//
+// --threads 0 (the default) uses every core. verify checks the symmetries
+// behind the database's position keys.
+
+#include "game_db.hpp"
+#include "notation.hpp"
+#include "symmetry.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+static void usage()
+{
+    cerr << "usage: gamedb build DB [--threads T] FILE...\n"
+            "       gamedb query DB [--size 8|10|12] [MOVES]\n"
+            "       gamedb info DB\n"
+            "       gamedb verify" << endl;
+}
+
+static void printRates(const char* what, uint64_t count, double seconds)
+{
+    cout << "  " << what << " " << count;
+    if (seconds > 0)
+        cout << " (" << fixed << setprecision(0) << count / seconds << "/s)";
+    cout << endl;
+}
+
+static int build(const string& db, vector<string> args)
+{
+    int threads = 0;
+    vector<string> inputs;
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "--threads" && i + 1 < args.size())
+            threads = atoi(args[++i].c_str());
+        else
+            inputs.push_back(args[i]);
+    }
+    if (inputs.empty()) {
+        usage();
+        return 2;
+    }
+    if (threads <= 0)
+        threads = max(1, (int)thread::hardware_concurrency());
+
+    DbBuildStats stats;
+    string error;
+    bool reported = false;
+    bool ok = buildGameDb(inputs, db, threads, stats, &error, [&](const DbBuildStats& s) {
+        cerr << "\r" << s.games << " games, " << s.positions << " positions" << flush;
+        reported = true;
+    });
+    if (reported)
+        cerr << endl;
+    if (!ok) {
+        cerr << error << endl;
+        return 1;
+    }
+    cout << db << ": " << threads << " threads, " << fixed << setprecision(2) << stats.seconds << " s" << endl;
+    printRates("games", stats.games, stats.seconds);
+    printRates("positions", stats.positions, stats.seconds);
+    cout << "  distinct " << stats.distinct << endl;
+    if (stats.skipped)
+        cout << "  skipped " << stats.skipped << " unfinished or unreadable games" << endl;
+    return 0;
+}
+
+static int query(const GameDb& db, vector<string> args)
+{
+    int size = 8;
+    string moves;
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "--size" && i + 1 < args.size())
+            size = atoi(args[++i].c_str());
+        else
+            moves += args[i];
+    }
+    if (size != 8 && size != 10 && size != 12) {
+        usage();
+        return 2;
+    }
+
+    AnyBoard board(size);
+    Disk side;
+    string error;
+    if (!playMoves(board, moves, side, &error)) {
+        cerr << error << endl;
+        return 1;
+    }
+
+    // Time the lookups of every legal move together, as the game does them
+    constexpr int REPEAT = 10000;
+    auto start = chrono::steady_clock::now();
+    vector<MoveStats> stats;
+    for (int r = 0; r < REPEAT; r++)
+        stats = db.moveStats(board, side);
+    double micros = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / REPEAT;
+
+    cout << (side == Disk::X ? "X" : "O") << " to move, " << stats.size() << " moves in the database ("
+         << fixed << setprecision(2) << micros << " us)" << endl;
+    for (const MoveStats& m : stats)
+        cout << "  " << char('a' + m.x) << m.y + 1 << setw(10) << m.games << " games  "
+             << setprecision(1) << 100 * m.score << "%" << endl;
+    return 0;
+}
+
+template <int N>
+static bool verifySymmetry()
+{
+    int bad = 0;
+    for (int s = 0; s < symmetry::COUNT; s++)
+        for (int sq = 0; sq < N * N; sq++)
+            if (symmetry::transform<N>(symmetry::transform<N>(sq, s), symmetry::inverse(s)) != sq)
+                bad++;
+    cout << "  " << N << "x" << N << " transform / inverse round trips: "
+         << (bad ? to_string(bad) + " MISMATCH" : "OK") << endl;
+    return !bad;
+}
+
+static int verify()
+{
+    bool ok = verifySymmetry<8>();
+    ok = verifySymmetry<10>() && ok;
+    ok = verifySymmetry<12>() && ok;
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 2 && string(argv[1]) == "verify")
+        return verify();
+    if (argc < 3) {
+        usage();
+        return 2;
+    }
+    string command = argv[1], path = argv[2];
+    vector<string> args(argv + 3, argv + argc);
+    if (command == "build")
+        return build(path, args);
+
+    GameDb db;
+    string error;
+    if (command != "query" && command != "info") {
+        usage();
+        return 2;
+    }
+    if (!db.open(path, &error)) {
+        cerr << error << endl;
+        return 1;
+    }
+    if (command == "query")
+        return query(db, args);
+    cout << path << ": " << db.games() << " games, " << db.positions() << " distinct positions" << endl;
+    return 0;
+}
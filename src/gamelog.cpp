@@ -0,0 +1,158 @@
+// gamelog: looks into the game logs written by Othello --record and selfplay,
+// and checks their crash recovery.
+//
+//   gamelog info LOG
+//   gamelog verify
+//
+// info only reads the log: unlike reopening it with --record, it neither
+// resumes nor truncates anything. verify writes scratch logs, cuts them off
+// the way a crash would and checks what reopening them keeps.
+
+#include "game_record.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static void usage()
+{
+    cerr << "usage: gamelog info LOG\n"
+            "       gamelog verify" << endl;
+}
+
+static int info(const string& path)
+{
+    ifstream in(path, ios::binary);
+    if (!in) {
+        cerr << path << ": cannot open" << endl;
+        return 1;
+    }
+    vector<uint8_t> data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    if (!GameLogReader::hasMagic(data.data(), data.size())) {
+        cerr << path << ": not a game log" << endl;
+        return 1;
+    }
+    GameLogReader reader(data.data(), data.size());
+    GameRecord game;
+    uint64_t counts[3] = {}, moves = 0;
+    while (reader.next(game)) {
+        counts[game.status]++;
+        moves += game.moves.size();
+    }
+    cout << path << ": " << counts[GameRecord::FINISHED] << " finished, " << counts[GameRecord::ABANDONED]
+         << " abandoned, " << counts[GameRecord::PLAYING] << " unfinished games, " << moves << " moves, "
+         << data.size() << " bytes" << endl;
+    if (reader.error()) {
+        cerr << path << ": " << reader.error() << " at byte " << reader.offset() << endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Writes a log with `write`, cuts `cut` bytes off its end as a crash would,
+// and reopens it: the file should keep `keep` bytes after the magic and
+// resume a game with `moves` and clocks `clockX` / `clockO` (or none when
+// `moves` is null).
+template <class Write>
+static bool verifyRecovery(const string& path, const char* what, Write write, size_t cut, size_t keep,
+                           const vector<uint8_t>* moves, uint32_t clockX = 0, uint32_t clockO = 0)
+{
+    unlink(path.c_str());
+    GameLog log;
+    string error;
+    bool ok = log.open(path, &error);
+    if (ok) {
+        write(log);
+        log.close();
+        struct stat st;
+        ok = stat(path.c_str(), &st) == 0 && truncate(path.c_str(), st.st_size - (off_t)cut) == 0 &&
+             log.open(path, &error) && stat(path.c_str(), &st) == 0 &&
+             (size_t)st.st_size == record::MAGIC_SIZE + keep;
+    }
+    const GameRecord* game = ok ? log.unfinished() : nullptr;
+    if (ok && moves)
+        ok = game && game->moves == *moves && game->clockMs[0] == clockX && game->clockMs[1] == clockO;
+    else if (ok)
+        ok = !game;
+    log.close();
+    cout << "  " << what << ": " << (ok ? "OK" : error.empty() ? "MISMATCH" : error) << endl;
+    return ok;
+}
+
+static int verify()
+{
+    char path[] = "/tmp/gamelog-verify-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        cerr << "cannot create a scratch log" << endl;
+        return 1;
+    }
+    close(fd);
+    using namespace record;
+    const uint32_t clocks[2] = { 1000, 2500 };
+    const int F5 = 37, D6 = 43, C3 = 18;
+    // f5 d6 c3, X wins 40-24: START, 3 moves, END
+    auto finished = [&](GameLog& log) {
+        log.beginGame(8, 0);
+        log.move(F5);
+        log.move(D6);
+        log.move(C3);
+        log.endGame(clocks, 40, 24);
+    };
+    const size_t FINISHED = START_SIZE + 3 + END_SIZE;
+    const vector<uint8_t> f5 = { F5 }, f5d6 = { F5, D6 };
+
+    bool ok = verifyRecovery(path, "finished game", finished, 0, FINISHED, nullptr);
+
+    ok = verifyRecovery(path, "cut inside END", [&](GameLog& log) {
+        finished(log);
+        log.beginGame(8, 0);
+        log.move(F5);
+        log.move(D6);
+        log.endGame(clocks, 2, 3);
+    }, END_SIZE - 4, FINISHED + START_SIZE + 2, &f5d6) && ok;
+
+    ok = verifyRecovery(path, "cut inside START", [&](GameLog& log) {
+        finished(log);
+        log.beginGame(10, 1);
+    }, 1, FINISHED, nullptr) && ok;
+
+    ok = verifyRecovery(path, "UNDO after a PASS", [&](GameLog& log) {
+        log.beginGame(8, 3);
+        log.move(F5);
+        log.move(D6);
+        log.move(PASS);
+        log.undo();
+    }, 0, START_SIZE + 4, &f5) && ok;
+
+    const uint32_t first[2] = { 1000, 0 };
+    ok = verifyRecovery(path, "cut inside CLOCK", [&](GameLog& log) {
+        log.beginGame(8, 0);
+        log.move(F5);
+        log.clocks(first);
+        log.move(D6);
+        log.clocks(clocks);
+    }, 4, START_SIZE + 1 + CLOCK_SIZE + 1, &f5d6, 1000, 0) && ok;
+
+    unlink(path);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    string command = argc > 1 ? argv[1] : "";
+    if (command == "info" && argc == 3)
+        return info(argv[2]);
+    if (command == "verify" && argc == 2)
+        return verify();
+    usage();
+    return 2;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+
+// Lazy SMP scaling benchmark (Othello --bench-smp): time-to-depth on a fixed
+// set of 8x8 positions at 1, 2, 4, ... threads up to maxThreads.
+int runSmpBenchmark(int maxThreads, int depth, size_t hashMB);
+
+// MCTS throughput (Othello --bench-mcts): playouts per second and per minute
+// from the opening position of every board size, at 1, 2, 4, ... threads.
+int runMctsBenchmark(int maxThreads, double seconds, size_t treeMB);
+
+class PatternEval;
+class Network;
+
+// Evaluator benchmark (Othello --bench-eval): evaluations per second of the
+// square-weight, pattern and neural evaluators, next to move generation on the
+// same 8x8 positions.
+int runEvalBenchmark(const PatternEval& patterns, const Network& net);
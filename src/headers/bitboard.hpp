@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+
+// 8x8 bitboard helpers.
+// Square index is y * 8 + x, so bit 0 is the top-left cell and a shift by +1
+// moves one column to the right, +8 moves one row down.
+namespace bitboard {
+
+// Every column except the left and right edge. Masking the "propagator" with it
+// stops horizontal and diagonal shifts from wrapping around to the next row.
+constexpr uint64_t NOT_EDGE_COLS = 0x7E7E7E7E7E7E7E7EULL;
+
+inline uint64_t bit(int sq) { return 1ULL << sq; }
+
+// Helpers shared by every bitboard width. The uint64_t overloads live here, the
+// Bits128/Bits256 ones in wide_bitboard.hpp, so Board<N> can call them uniformly.
+template <class B> B squareBit(int sq);
+template <> inline uint64_t squareBit<uint64_t>(int sq) { return 1ULL << sq; }
+
+inline bool test(uint64_t b, int sq) { return (b >> sq) & 1; }
+inline bool any(uint64_t b) { return b != 0; }
+inline int popcount(uint64_t b) { return __builtin_popcountll(b); }
+
+// Removes the lowest set bit of a non-empty mask and returns its square.
+inline int popLowest(uint64_t& b)
+{
+    int sq = __builtin_ctzll(b);
+    b &= b - 1;
+    return sq;
+}
+
+template <int S>
+inline uint64_t shift(uint64_t b)
+{
+    if constexpr (S > 0)
+        return b << S;
+    else
+        return b >> -S;
+}
+
+// Kogge-Stone occluded fill: extends every bit of gen along direction S through
+// the cells set in pro. Three doubling steps cover the longest possible run (6).
+template <int S>
+inline uint64_t fill(uint64_t gen, uint64_t pro)
+{
+    gen |= pro & shift<S>(gen);
+    pro &= shift<S>(pro);
+    gen |= pro & shift<2 * S>(gen);
+    pro &= shift<2 * S>(pro);
+    gen |= pro & shift<4 * S>(gen);
+    return gen;
+}
+
+template <int S>
+inline uint64_t movesDir(uint64_t own, uint64_t pro, uint64_t empty)
+{
+    return shift<S>(fill<S>(shift<S>(own) & pro, pro)) & empty;
+}
+
+// Opponent run starting next to `from` in direction S, if it is closed by an own disk.
+template <int S>
+inline uint64_t flipsDir(uint64_t from, uint64_t own, uint64_t pro)
+{
+    uint64_t run = fill<S>(shift<S>(from) & pro, pro);
+    return (shift<S>(run) & own) ? run : 0;
+}
+
+// All legal moves for the side owning `own`, computed for every square at once.
+inline uint64_t moves(uint64_t own, uint64_t opp)
+{
+    uint64_t empty = ~(own | opp);
+    uint64_t inner = opp & NOT_EDGE_COLS;
+
+    return movesDir<8>(own, opp, empty)   | movesDir<-8>(own, opp, empty) |
+           movesDir<1>(own, inner, empty) | movesDir<-1>(own, inner, empty) |
+           movesDir<9>(own, inner, empty) | movesDir<-9>(own, inner, empty) |
+           movesDir<7>(own, inner, empty) | movesDir<-7>(own, inner, empty);
+}
+
+// Discs flipped by the side owning `own` playing on the empty square `sq`.
+inline uint64_t flips(int sq, uint64_t own, uint64_t opp)
+{
+    uint64_t from = bit(sq);
+    uint64_t inner = opp & NOT_EDGE_COLS;
+
+    return flipsDir<8>(from, own, opp)   | flipsDir<-8>(from, own, opp) |
+           flipsDir<1>(from, own, inner) | flipsDir<-1>(from, own, inner) |
+           flipsDir<9>(from, own, inner) | flipsDir<-9>(from, own, inner) |
+           flipsDir<7>(from, own, inner) | flipsDir<-7>(from, own, inner);
+}
+
+// Discs of `own` that can never be flipped again, as a lower bound: a disc is
+// counted when, on each of the four axes, it sits on the edge, on a line with
+// no empty square, or next to another stable disc of its colour.
+inline uint64_t stable(uint64_t own, uint64_t opp)
+{
+    constexpr uint64_t NOT_LEFT = 0xFEFEFEFEFEFEFEFEULL;   // valid targets when moving right
+    constexpr uint64_t NOT_RIGHT = 0x7F7F7F7F7F7F7F7FULL;  // valid targets when moving left
+    constexpr uint64_t SIDES = 0x8181818181818181ULL;
+    constexpr uint64_t TOP_BOTTOM = 0xFF000000000000FFULL;
+
+    // Squares sharing a line with an empty square, per axis
+    uint64_t empty = ~(own | opp);
+    uint64_t openH = fill<1>(empty, NOT_LEFT) | fill<-1>(empty, NOT_RIGHT);
+    uint64_t openV = fill<8>(empty, ~0ULL) | fill<-8>(empty, ~0ULL);
+    uint64_t openD9 = fill<9>(empty, NOT_LEFT) | fill<-9>(empty, NOT_RIGHT);
+    uint64_t openD7 = fill<7>(empty, NOT_RIGHT) | fill<-7>(empty, NOT_LEFT);
+
+    uint64_t safeH = ~openH | SIDES;
+    uint64_t safeV = ~openV | TOP_BOTTOM;
+    uint64_t safeD9 = ~openD9 | SIDES | TOP_BOTTOM;
+    uint64_t safeD7 = ~openD7 | SIDES | TOP_BOTTOM;
+
+    uint64_t st = own & safeH & safeV & safeD9 & safeD7;
+    for (;;) {
+        uint64_t h = safeH | ((st << 1) & NOT_LEFT) | ((st >> 1) & NOT_RIGHT);
+        uint64_t v = safeV | (st << 8) | (st >> 8);
+        uint64_t d9 = safeD9 | ((st << 9) & NOT_LEFT) | ((st >> 9) & NOT_RIGHT);
+        uint64_t d7 = safeD7 | ((st << 7) & NOT_RIGHT) | ((st >> 7) & NOT_LEFT);
+        uint64_t next = st | (own & h & v & d9 & d7);
+        if (next == st)
+            return st;
+        st = next;
+    }
+}
+
+} // namespace bitboard
@@ -1,36 +1,221 @@
 #pragma once
 
+#include <cassert>
+#include <cstdint>
 #include <string>
+#include <type_traits>
 #include <utility>
+#include <variant>
 #include <vector>
 
+#include "bitboard.hpp"
+#include "wide_bitboard.hpp"
+#include "zobrist.hpp"
+
+enum class Disk { Empty = 0, X, O };
+
+inline Disk opponent(Disk d) {
+    return d == Disk::X ? Disk::O : Disk::X;
+}
+
+// Bitboard word and move generator for each supported board size.
+template <int N> struct BoardBits;
+
+template <> struct BoardBits<8> {
+    using type = uint64_t;
+    static uint64_t moves(uint64_t own, uint64_t opp) { return bitboard::moves(own, opp); }
+    static uint64_t flips(int sq, uint64_t own, uint64_t opp) { return bitboard::flips(sq, own, opp); }
+};
+
+template <> struct BoardBits<10> {
+    using type = Bits128;
+    static Bits128 moves(const Bits128& own, const Bits128& opp) { return widebits::kernels10.moves(own, opp); }
+    static Bits128 flips(int sq, const Bits128& own, const Bits128& opp) { return widebits::kernels10.flips(sq, own, opp); }
+};
+
+template <> struct BoardBits<12> {
+    using type = Bits256;
+    static Bits256 moves(const Bits256& own, const Bits256& opp) { return widebits::kernels12.moves(own, opp); }
+    static Bits256 flips(int sq, const Bits256& own, const Bits256& opp) { return widebits::kernels12.flips(sq, own, opp); }
+};
+
+// An N x N board stored as two bitboards. It is a plain fixed-size value
+// (trivially copyable, no heap), so search code can copy it on the stack.
+// Square index is y * N + x.
+template <int N>
 class Board {
 public:
-    enum class Disk { Empty = 0, X, O };
+    using Bits = typename BoardBits<N>::type;
+    static constexpr int SIZE = N;
+    static constexpr int CELLS = N * N;
+
+    // What a move changed: enough for undo() to restore the position in place,
+    // so lookahead never needs to copy or allocate a board.
+    struct Undo {
+        Bits flipped;
+        uint64_t key;   // Zobrist key before the move
+        int sq;
+        Disk who;
+    };
 
 private:
-    int boardSize;
-    Disk** grid;
+    Bits bitsX;
+    Bits bitsO;
+    uint64_t key;       // Zobrist key of the discs (side to move not included)
+
+    static int colour(Disk d) { return d == Disk::X ? 0 : 1; }
+
+    void rehash()
+    {
+        key = 0;
+        for (Bits b = bitsX; bitboard::any(b); ) key ^= ZOBRIST<N>.disc[0][bitboard::popLowest(b)];
+        for (Bits b = bitsO; bitboard::any(b); ) key ^= ZOBRIST<N>.disc[1][bitboard::popLowest(b)];
+    }
+
+    Bits& bitsOf(Disk d) { return d == Disk::X ? bitsX : bitsO; }
+    const Bits& bitsOf(Disk d) const { return d == Disk::X ? bitsX : bitsO; }
+
+public:
+    explicit Board(bool initial = true) : bitsX{}, bitsO{}, key(0)
+    {
+        if (initial)
+            reset();
+    }
+
+    void reset()
+    {
+        constexpr int c = N / 2;
+        bitsX = bitboard::squareBit<Bits>((c-1) * N + c) | bitboard::squareBit<Bits>(c * N + c-1);
+        bitsO = bitboard::squareBit<Bits>((c-1) * N + c-1) | bitboard::squareBit<Bits>(c * N + c);
+        rehash();
+    }
+
+    static constexpr int getSize() { return N; }
+
+    bool isValid(int x, int y, Disk current) const
+    {
+        return bitboard::test(moves(current), y * N + x);
+    }
 
-    bool scan(int startX, int startY, int dx, int dy, Disk current) const;
-    void scanAndFlip(int startX, int startY, int dx, int dy);
+    std::vector<std::pair<int, int>> getValid(Disk current) const
+    {
+        std::vector<std::pair<int, int>> out;
+        for (Bits m = moves(current); bitboard::any(m); ) {
+            int sq = bitboard::popLowest(m);
+            out.emplace_back(sq % N, sq / N);
+        }
+        return out;
+    }
+
+    Undo put(int x, int y, Disk current) { return play(y * N + x, current); }
+
+    Disk get(int x, int y) const
+    {
+        int sq = y * N + x;
+        if (bitboard::test(bitsX, sq)) return Disk::X;
+        if (bitboard::test(bitsO, sq)) return Disk::O;
+        return Disk::Empty;
+    }
+
+    int count(Disk who) const
+    {
+        if (who == Disk::Empty)
+            return CELLS - bitboard::popcount(bitsX | bitsO);
+        return bitboard::popcount(bitsOf(who));
+    }
+
+    // Overwrite one cell without flipping anything (for setting up positions).
+    void set(int x, int y, Disk d)
+    {
+        Bits b = bitboard::squareBit<Bits>(y * N + x);
+        bitsX = bitsX & ~b;
+        bitsO = bitsO & ~b;
+        if (d != Disk::Empty)
+            bitsOf(d) = bitsOf(d) | b;
+        rehash();
+    }
+
+    // Bitboard interface for search code.
+    const Bits& discs(Disk who) const { return bitsOf(who); }
+    uint64_t hash() const { return key; }
+    // Key for transposition tables: the discs plus the side to move.
+    uint64_t hash(Disk toMove) const { return toMove == Disk::O ? key ^ ZOBRIST<N>.side : key; }
+    Bits moves(Disk current) const { return BoardBits<N>::moves(bitsOf(current), bitsOf(opponent(current))); }
+    Bits flips(int sq, Disk current) const { return BoardBits<N>::flips(sq, bitsOf(current), bitsOf(opponent(current))); }
+
+    Undo play(int sq, Disk current)
+    {
+        Bits& own = bitsOf(current);
+        Bits& opp = bitsOf(opponent(current));
+        assert(!bitboard::test(own | opp, sq));
+        Bits flipped = BoardBits<N>::flips(sq, own, opp);
+        own = own | flipped | bitboard::squareBit<Bits>(sq);
+        opp = opp ^ flipped;
+
+        Undo u{ flipped, key, sq, current };
+        key ^= ZOBRIST<N>.disc[colour(current)][sq];
+        for (Bits f = flipped; bitboard::any(f); )
+            key ^= ZOBRIST<N>.flip[bitboard::popLowest(f)];
+        return u;
+    }
+
+    // Reverts the move that returned u. Moves must be undone in reverse order.
+    void undo(const Undo& u)
+    {
+        Bits& own = bitsOf(u.who);
+        Bits& opp = bitsOf(opponent(u.who));
+        own = own ^ (u.flipped | bitboard::squareBit<Bits>(u.sq));
+        opp = opp | u.flipped;
+        key = u.key;
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<Board<8>> &&
+              std::is_trivially_copyable_v<Board<10>> &&
+              std::is_trivially_copyable_v<Board<12>>, "boards must stay plain values");
+
+// A Board<N> together with the undo records of the moves played on it.
+template <int N>
+struct BoardState {
+    Board<N> board;
+    std::vector<typename Board<N>::Undo> undos;
+};
+
+// Runtime-sized board used by Game and Renderer: the menu choice picks the
+// Board<N> instantiation once, and every call is forwarded to it.
+// Disc counts are kept up to date by put/undo, and each side's legal-move list
+// is built at most once per position, so the UI can ask for them every frame.
+class AnyBoard {
+    std::variant<BoardState<8>, BoardState<10>, BoardState<12>> impl;
+
+    int discs[3];   // indexed by Disk: Empty, X, O
+    mutable std::vector<std::pair<int, int>> validCache[2];
+    mutable bool validFresh[2];
+
+    void positionChanged() { validFresh[0] = validFresh[1] = false; }
 
 public:
-    Board(int size = 8, bool initial = true);
-    ~Board();
+    explicit AnyBoard(int size = 8);
+    int getSize() const;
     void reset();
-    int getSize() const { return boardSize; }
 
     bool isValid(int x, int y, Disk current) const;
-    std::vector<std::pair<int, int>> getValid(Disk current) const;
+    const std::vector<std::pair<int, int>>& getValid(Disk current) const;
     void put(int x, int y, Disk current);
+    // Take back the last put(). Returns false when no move is left to undo.
+    bool undo();
     Disk get(int x, int y) const;
 
-    int count(Disk who) const;
-};
-
-inline Board::Disk opponent(Board::Disk d) {
-    return d == Board::Disk::X ? Board::Disk::O : Board::Disk::X;
-}
-
+    int count(Disk who) const { return discs[(int)who]; }
 
+    // Run f on the concrete Board<N>&, e.g. to hand it to an engine.
+    // Use the mutating version only for changes that are undone before it returns.
+    template <class F> decltype(auto) visit(F&& f)
+    {
+        return std::visit([&](auto& s) -> decltype(auto) { return f(s.board); }, impl);
+    }
+    template <class F> decltype(auto) visit(F&& f) const
+    {
+        return std::visit([&](const auto& s) -> decltype(auto) { return f(s.board); }, impl);
+    }
+};
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <vector>
+
 // Input control keys
 // const int KEY_UP = 65;    // Arrow Up
 // const int KEY_DOWN = 66;  // Arrow Down
@@ -18,10 +21,36 @@ enum class InputKey {
     ESC,
     Q, // Quit to menu
     R,  // Restart game
+    U,  // Undo last move
     LEFT_BRACKET, // '[' key
     RIGHT_BRACKET // ']' key
 };
 
+// A decoded key press: the game key it maps to (NONE if any) and, for plain
+// characters, the character itself so menus can read digits.
+struct Key {
+    InputKey key = InputKey::NONE;
+    char ch = 0;
+};
+
+// Turns the bytes read from a raw-mode terminal into keys. It keeps its state
+// between calls, so an escape sequence split over several reads still comes
+// out as one arrow key. A lone ESC cannot be told apart from the start of a
+// sequence until the next byte: while pending() is true the caller should
+// wait at most ESC_TIMEOUT_MS for more input and call timeout() if none comes.
+class KeyDecoder {
+public:
+    static constexpr int ESC_TIMEOUT_MS = 25;
+
+    void feed(const char* bytes, size_t n, std::vector<Key>& out);
+    bool pending() const { return state != GROUND; }
+    void timeout(std::vector<Key>& out);
+
+private:
+    enum State { GROUND, ESCAPE, CSI, SS3 };
+    State state = GROUND;
+};
+
 // Play sound effects
 // enum SoundEffect {
 //     CLICK,
@@ -30,4 +59,3 @@ enum class InputKey {
 // };
 
 // void playSound(SoundEffect effect);
-InputKey getInputKey();
\ No newline at end of file
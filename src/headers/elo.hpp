@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+// Match statistics for engine A against engine B, over pairs of games that
+// share an opening with the colours swapped. A pair scores 0 to 2 points for
+// A in half points, so the results follow a pentanomial distribution. The two
+// games of a pair are not independent (a lopsided opening tends to win with
+// either colour), and counting pairs rather than games keeps the error bars
+// honest.
+namespace elo {
+
+// Elo difference for an expected score in (0, 1), and back.
+double fromScore(double score);
+double toScore(double elo);
+
+struct Pentanomial {
+    uint64_t pairs[5] = {};     // by A's points in the pair: 0, 0.5, 1, 1.5, 2
+
+    void add(int halfPoints) { pairs[halfPoints]++; }
+    uint64_t count() const;
+    double score() const;       // A's mean score per game
+    double variance() const;    // of a pair's mean score
+    double elo() const;
+    // Half-width of the 95% confidence interval, in Elo (0 before two pairs)
+    double errorMargin() const;
+    // Log-likelihood ratio of H1 (elo1) against H0 (elo0), by the normal
+    // approximation of the generalised SPRT
+    double llr(double elo0, double elo1) const;
+};
+
+// Sequential probability ratio test: stops a match as soon as it shows, with
+// error rates alpha and beta, that A is elo1 stronger (H1) rather than elo0.
+struct Sprt {
+    double elo0 = 0, elo1 = 5;
+    double alpha = 0.05, beta = 0.05;
+
+    double lower() const;
+    double upper() const;
+    // 1: H1 accepted, -1: H0 accepted, 0: play on
+    int decide(const Pentanomial& p) const;
+};
+
+} // namespace elo
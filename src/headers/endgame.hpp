@@ -0,0 +1,379 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "board.hpp"
+#include "eval.hpp"
+#include "tt.hpp"
+
+// Exact endgame solver: searches every line to the end of the game and returns
+// the final disc difference under perfect play. It takes over from the midgame
+// search once few enough squares are empty.
+//
+// Move ordering is fastest-first (fewest opponent replies) with a bonus for
+// squares in a quadrant holding an odd number of empties (region parity).
+// Nodes with a few empties left skip sorting and the table, and the last four
+// skip move generation: each remaining square is simply tried in parity order by
+// the solveLast<E> routines. On 8x8 a stable-disc bound cuts hopeless lines.
+
+struct EndgameResult {
+    int move = -1;          // best square, -1 when the side must pass
+    int diff = 0;           // own discs minus opponent discs at the end
+    bool exact = false;     // false when time ran out before the solve finished
+    uint64_t nodes = 0;
+};
+
+template <int N>
+constexpr std::array<int, N * N> makeQuadrants()
+{
+    std::array<int, N * N> q{};
+    for (int sq = 0; sq < N * N; sq++)
+        q[sq] = (sq / N >= N / 2 ? 2 : 0) + (sq % N >= N / 2 ? 1 : 0);
+    return q;
+}
+
+template <int N>
+class Endgame {
+public:
+    using Bits = typename Board<N>::Bits;
+    using Clock = std::chrono::steady_clock;
+
+    explicit Endgame(TranspositionTable* table = nullptr) : tt(table), full{}, corners{}
+    {
+        for (int sq = 0; sq < N * N; sq++)
+            full = full | bitboard::squareBit<Bits>(sq);
+        corners = bitboard::squareBit<Bits>(0) | bitboard::squareBit<Bits>(N - 1) |
+                  bitboard::squareBit<Bits>(N * (N - 1)) | bitboard::squareBit<Bits>(N * N - 1);
+    }
+
+    // Same meaning as Search::share.
+    void share(std::atomic<bool>* stop, int id)
+    {
+        stopFlag = stop;
+        threadId = id;
+    }
+
+    // Squares still empty when the game ends count for nobody, as in finalScore.
+    // When the deadline or the stop flag ends the solve early, `move` is the best
+    // root move proven so far.
+    EndgameResult solve(const Board<N>& root, Disk side, Clock::time_point until = Clock::time_point::max())
+    {
+        deadline = until;
+        nodes = 0;
+        aborted = false;
+
+        EndgameResult result;
+        const Bits& own = root.discs(side);
+        const Bits& opp = root.discs(opponent(side));
+        int empties = root.count(Disk::Empty);
+        unsigned parity = 0;
+        for (Bits e = ~(own | opp) & full; bitboard::any(e); )
+            parity ^= 1u << QUADRANT[bitboard::popLowest(e)];
+
+        int moves[Board<N>::CELLS];
+        Bits flipped[Board<N>::CELLS];
+        int count = orderedMoves(own, opp, parity, -1, moves, flipped);
+        if (count == 0) {
+            result.diff = node(own, opp, root.hash(), side, -MAX_DIFF, MAX_DIFF, false, empties, parity);
+            result.exact = !aborted;
+            result.nodes = nodes;
+            return result;
+        }
+        if (threadId > 0) {
+            std::rotate(moves, moves + threadId % count, moves + count);
+            std::rotate(flipped, flipped + threadId % count, flipped + count);
+        }
+
+        int alpha = -MAX_DIFF;
+        result.move = moves[0];
+        for (int i = 0; i < count; i++) {
+            Child c = child(own, opp, root.hash(), side, moves[i], flipped[i], parity);
+            int score;
+            if (i == 0) {
+                score = -node(c.own, c.opp, c.key, opponent(side), -MAX_DIFF, -alpha, false, empties - 1, c.parity);
+            } else {
+                score = -node(c.own, c.opp, c.key, opponent(side), -alpha - 1, -alpha, false, empties - 1, c.parity);
+                if (score > alpha && !aborted)
+                    score = -node(c.own, c.opp, c.key, opponent(side), -MAX_DIFF, -alpha, false, empties - 1, c.parity);
+            }
+            if (aborted)
+                break;
+            if (score > alpha) {
+                alpha = score;
+                result.move = moves[i];
+            }
+        }
+        result.diff = alpha;
+        result.exact = !aborted;
+        result.nodes = nodes;
+        if (tt && result.exact)
+            tt->store(root.hash(side), exactScore(alpha), empties, result.move, TranspositionTable::EXACT);
+        return result;
+    }
+
+private:
+    static constexpr int MAX_DIFF = N * N + 1;
+    // Up to this many empties, nodes skip the table and fastest-first sorting:
+    // those subtrees are cheaper to search than to order or probe.
+    static constexpr int SHALLOW_EMPTIES = 6;
+    static constexpr int STABILITY_MIN_ALPHA = 16;  // the cutoff rarely fires below this
+    static constexpr std::array<int, N * N> QUADRANT = makeQuadrants<N>();
+
+    TranspositionTable* tt;
+    Bits full;
+    Bits corners;
+    Clock::time_point deadline;
+    uint64_t nodes = 0;
+    bool aborted = false;
+    std::atomic<bool>* stopFlag = nullptr;
+    int threadId = 0;
+
+    // Position after a move, seen from the opponent who is now to move.
+    struct Child {
+        Bits own;
+        Bits opp;
+        uint64_t key;   // Zobrist key of the discs, as Board<N>::hash()
+        unsigned parity;
+    };
+
+    Child child(const Bits& own, const Bits& opp, uint64_t key, Disk side, int sq, const Bits& f, unsigned parity) const
+    {
+        Child c{ opp ^ f, own | f | bitboard::squareBit<Bits>(sq), key, parity ^ 1u << QUADRANT[sq] };
+        if (!tt)
+            return c;
+        c.key ^= ZOBRIST<N>.disc[side == Disk::X ? 0 : 1][sq];
+        for (Bits b = f; bitboard::any(b); )
+            c.key ^= ZOBRIST<N>.flip[bitboard::popLowest(b)];
+        return c;
+    }
+
+    // The opponent's stable discs cap what the side to move can still reach.
+    // Only the 8x8 board has a stability routine; on the others this never cuts.
+    bool stabilityCutoff(const Bits& own, const Bits& opp, int alpha) const
+    {
+        if constexpr (N == 8) {
+            if (alpha >= STABILITY_MIN_ALPHA)
+                return N * N - 2 * bitboard::popcount(bitboard::stable(opp, own)) <= alpha;
+        }
+        return false;
+    }
+
+    static int discDiff(const Bits& own, const Bits& opp) { return bitboard::popcount(own) - bitboard::popcount(opp); }
+
+    // Legal moves and their flips, few opponent replies and odd-parity quadrants first.
+    int orderedMoves(const Bits& own, const Bits& opp, unsigned parity, int ttMove, int* out, Bits* flipped) const
+    {
+        int keys[Board<N>::CELLS];
+        int n = 0;
+        for (Bits m = BoardBits<N>::moves(own, opp); bitboard::any(m); n++) {
+            int sq = bitboard::popLowest(m);
+            Bits f = BoardBits<N>::flips(sq, own, opp);
+            Bits reply = BoardBits<N>::moves(opp ^ f, own | f | bitboard::squareBit<Bits>(sq));
+            int key = 4 * (bitboard::popcount(reply) + bitboard::popcount(reply & corners)) +
+                      ((parity >> QUADRANT[sq] & 1) ? 0 : 1);
+            if (sq == ttMove)
+                key = -1;
+            // insertion sort, lowest key first
+            int i = n;
+            for (; i > 0 && keys[i - 1] > key; i--) {
+                keys[i] = keys[i - 1];
+                out[i] = out[i - 1];
+                flipped[i] = flipped[i - 1];
+            }
+            keys[i] = key;
+            out[i] = sq;
+            flipped[i] = f;
+        }
+        return n;
+    }
+
+    int node(const Bits& own, const Bits& opp, uint64_t key, Disk side, int alpha, int beta, bool passed,
+             int empties, unsigned parity)
+    {
+        if (empties <= SHALLOW_EMPTIES)
+            return shallow(own, opp, alpha, beta, passed, empties, parity);
+
+        if ((++nodes & 1023) == 0 &&
+            (Clock::now() >= deadline || (stopFlag && stopFlag->load(std::memory_order_relaxed))))
+            aborted = true;
+        if (aborted)
+            return 0;
+
+        if (stabilityCutoff(own, opp, alpha))
+            return alpha;
+
+        uint64_t ttKey = side == Disk::O ? key ^ ZOBRIST<N>.side : key;
+        int ttMove = -1;
+        if (tt) {
+            TranspositionTable::Hit hit;
+            if (tt->probe(ttKey, hit)) {
+                ttMove = hit.move;
+                // Entries at least as deep as the empties are exact game results
+                if (hit.depth >= empties) {
+                    int diff = discDifference(hit.score);
+                    if (hit.bound == TranspositionTable::EXACT ||
+                        (hit.bound == TranspositionTable::LOWER && diff >= beta) ||
+                        (hit.bound == TranspositionTable::UPPER && diff <= alpha))
+                        return diff;
+                }
+            }
+        }
+
+        int moves[Board<N>::CELLS];
+        Bits flipped[Board<N>::CELLS];
+        int count = orderedMoves(own, opp, parity, ttMove, moves, flipped);
+        if (count == 0) {
+            if (passed)
+                return discDiff(own, opp);
+            return -node(opp, own, key, opponent(side), -beta, -alpha, true, empties, parity);
+        }
+
+        int originalAlpha = alpha;
+        int best = -MAX_DIFF, bestMove = -1;
+        for (int i = 0; i < count; i++) {
+            Child c = child(own, opp, key, side, moves[i], flipped[i], parity);
+            int score;
+            if (i == 0) {
+                score = -node(c.own, c.opp, c.key, opponent(side), -beta, -alpha, false, empties - 1, c.parity);
+            } else {
+                // Later moves only need to be proven worse: null window first
+                score = -node(c.own, c.opp, c.key, opponent(side), -alpha - 1, -alpha, false, empties - 1, c.parity);
+                if (score > alpha && score < beta && !aborted)
+                    score = -node(c.own, c.opp, c.key, opponent(side), -beta, -alpha, false, empties - 1, c.parity);
+            }
+            if (aborted)
+                return 0;
+            if (score > best) {
+                best = score;
+                bestMove = moves[i];
+                if (score > alpha) {
+                    alpha = score;
+                    if (alpha >= beta)
+                        break;
+                }
+            }
+        }
+
+        if (tt) {
+            auto bound = best >= beta ? TranspositionTable::LOWER
+                       : best > originalAlpha ? TranspositionTable::EXACT
+                       : TranspositionTable::UPPER;
+            tt->store(ttKey, exactScore(best), empties, bestMove, bound);
+        }
+        return best;
+    }
+
+    // Nodes near the end: moves in odd-parity quadrants first, no sorting.
+    int shallow(const Bits& own, const Bits& opp, int alpha, int beta, bool passed, int empties, unsigned parity)
+    {
+        if (empties <= 4)
+            return solveSmall(own, opp, alpha, beta, passed, empties, parity);
+        nodes++;
+        if (stabilityCutoff(own, opp, alpha))
+            return alpha;
+
+        Bits moves = BoardBits<N>::moves(own, opp);
+        if (!bitboard::any(moves)) {
+            if (passed)
+                return discDiff(own, opp);
+            return -shallow(opp, own, -beta, -alpha, true, empties, parity);
+        }
+
+        int best = -MAX_DIFF;
+        for (int pass = 0; pass < 2; pass++) {
+            for (Bits m = moves; bitboard::any(m); ) {
+                int sq = bitboard::popLowest(m);
+                if ((parity >> QUADRANT[sq] & 1) == (unsigned)pass)
+                    continue; // odd quadrants in the first pass, even ones in the second
+                Bits f = BoardBits<N>::flips(sq, own, opp);
+                int score = -shallow(opp ^ f, own | f | bitboard::squareBit<Bits>(sq), -beta, -alpha, false,
+                                     empties - 1, parity ^ 1u << QUADRANT[sq]);
+                if (score > best) {
+                    best = score;
+                    if (score > alpha) {
+                        alpha = score;
+                        if (alpha >= beta)
+                            return best;
+                    }
+                }
+            }
+        }
+        return best;
+    }
+
+    // Hands the last few empties to solveLast<E>, odd-parity quadrants first.
+    int solveSmall(const Bits& own, const Bits& opp, int alpha, int beta, bool passed, int empties, unsigned parity)
+    {
+        int squares[4];
+        int n = 0;
+        Bits empty = ~(own | opp) & full;
+        for (Bits e = empty; bitboard::any(e); ) {
+            int sq = bitboard::popLowest(e);
+            if (parity >> QUADRANT[sq] & 1)
+                squares[n++] = sq;
+        }
+        for (Bits e = empty; bitboard::any(e); ) {
+            int sq = bitboard::popLowest(e);
+            if (!(parity >> QUADRANT[sq] & 1))
+                squares[n++] = sq;
+        }
+
+        switch (empties) {
+            case 4: return solveLast<4>(own, opp, alpha, beta, squares, passed);
+            case 3: return solveLast<3>(own, opp, alpha, beta, squares, passed);
+            case 2: return solveLast<2>(own, opp, alpha, beta, squares, passed);
+            case 1: return solveLast<1>(own, opp, alpha, beta, squares, passed);
+            default: return discDiff(own, opp);
+        }
+    }
+
+    template <int E>
+    int solveLast(const Bits& own, const Bits& opp, int alpha, int beta, const int* squares, bool passed)
+    {
+        nodes++;
+        if constexpr (E == 1) {
+            // Last square: whoever can play it does, otherwise the game just ends
+            int sq = squares[0];
+            int diff = discDiff(own, opp);
+            Bits f = BoardBits<N>::flips(sq, own, opp);
+            if (bitboard::any(f))
+                return diff + 2 * bitboard::popcount(f) + 1;
+            f = BoardBits<N>::flips(sq, opp, own);
+            if (bitboard::any(f))
+                return diff - 2 * bitboard::popcount(f) - 1;
+            return diff;
+        } else {
+            int best = -MAX_DIFF;
+            for (int i = 0; i < E; i++) {
+                int sq = squares[i];
+                Bits f = BoardBits<N>::flips(sq, own, opp);
+                if (!bitboard::any(f))
+                    continue;
+
+                int rest[E - 1];
+                for (int j = 0, k = 0; j < E; j++)
+                    if (j != i) rest[k++] = squares[j];
+                Bits newOwn = own | f | bitboard::squareBit<Bits>(sq);
+                Bits newOpp = opp ^ f;
+                int score = -solveLast<E - 1>(newOpp, newOwn, -beta, -alpha, rest, false);
+                if (score > best) {
+                    best = score;
+                    if (score > alpha) {
+                        alpha = score;
+                        if (alpha >= beta)
+                            break;
+                    }
+                }
+            }
+            if (best > -MAX_DIFF)
+                return best;
+            if (passed)
+                return discDiff(own, opp);
+            return -solveLast<E>(opp, own, -beta, -alpha, squares, true);
+        }
+    }
+};
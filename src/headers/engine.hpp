@@ -0,0 +1,644 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "board.hpp"
+#include "endgame.hpp"
+#include "eval.hpp"
+#include "mcts.hpp"
+#include "nnue.hpp"
+#include "opening_book.hpp"
+#include "pattern_eval.hpp"
+#include "tt.hpp"
+
+// Computer player: negamax alpha-beta with iterative deepening. Each think()
+// call gets a time budget; the search checks the clock and its stop flag every
+// thousand nodes (well under a millisecond) and returns the best move of the
+// deepest finished iteration.
+// Positions are cached in a transposition table keyed by the board's
+// incremental Zobrist hash; its best move is searched first. With few enough
+// empty squares left, the exact endgame solver replaces the whole search.
+// On 8x8 the square weights of evaluate() can be swapped for the pattern
+// evaluator or the neural one. Their incremental state (pattern indices or
+// accumulator) follows every play/undo; the pattern batch scorer also orders
+// the moves of deeper nodes.
+//
+// Engine runs several Search<N> workers in Lazy SMP style: every thread searches
+// the whole tree on its own board, and they only cooperate through the shared
+// table. Helpers start at staggered depths with a rotated root order so they
+// fill the table with different subtrees than the main thread.
+// Engine can also run Mcts<N> (mcts.hpp) on the same threads instead, which
+// needs no evaluation and copes better with the 10x10 / 12x12 boards.
+
+struct SearchLimits {
+    double seconds = 0.5;   // per-move budget
+    int maxDepth = 64;
+    int exactEmpties = 20;  // solve exactly at or below this many empty squares
+};
+
+// Seconds for the next move with `remaining` on the mover's clock and
+// `empties` squares left: an even share of the moves still to play, plus the
+// increment, but never more than half of what is left.
+double moveBudget(double remaining, double increment, int empties);
+
+struct SearchResult {
+    int move = -1;          // square index y * N + x, -1 when the side must pass
+    int score = 0;          // from the mover's point of view
+    int depth = 0;          // deepest fully searched iteration
+    uint64_t nodes = 0;
+    double seconds = 0;
+    uint64_t ttProbes = 0;
+    uint64_t ttHits = 0;     // probes that found the position
+    uint64_t ttCutoffs = 0;  // hits whose bound ended the node without searching it
+    bool exact = false;      // score is the solved disc difference (see exactScore)
+    double winRate = -1;     // MCTS only: expected result of the move for the mover, 0..1
+    bool pondered = false;   // answered from the ponder search, without searching again
+    bool book = false;       // taken from the opening book, without searching
+
+    double nps() const { return seconds > 0 ? nodes / seconds : 0; }
+    double ttHitRate() const { return ttProbes ? (double)ttHits / ttProbes : 0; }
+    double ttCutoffRate() const { return ttProbes ? (double)ttCutoffs / ttProbes : 0; }
+};
+
+// Snapshot of a running think(), reported after every finished iteration and
+// every PROGRESS_INTERVAL seconds in between.
+struct SearchProgress {
+    int depth = 0;          // deepest finished iteration (MCTS: deepest tree node)
+    int score = 0;          // of that iteration, from the mover's point of view
+    uint64_t nodes = 0;     // all threads so far (MCTS: playouts)
+    double seconds = 0;
+    double winRate = -1;    // MCTS only
+    std::vector<int> pv;    // expected line from the root, -1 for a pass
+};
+
+using ProgressFn = std::function<void(const SearchProgress&)>;
+
+constexpr double PROGRESS_INTERVAL = 0.1;
+
+// Cache-line aligned so the hot counters of neighbouring workers in a vector
+// do not share a line.
+template <int N>
+class alignas(64) Search {
+public:
+    using Bits = typename Board<N>::Bits;
+    using Clock = std::chrono::steady_clock;
+
+    explicit Search(TranspositionTable* table = nullptr) : tt(table), endgame(table) {}
+
+    // Joins a thread group: `stop` is raised by whichever worker finishes first,
+    // `id` (0 = main thread) picks the helper's depth and move-order offsets.
+    // Workers add their node counts to `liveNodes`; the one given `progress`
+    // reports through it.
+    void share(std::atomic<bool>* stop, int id, std::atomic<uint64_t>* liveNodes = nullptr,
+               const ProgressFn* progress = nullptr)
+    {
+        stopFlag = stop;
+        threadId = id;
+        sharedNodes = liveNodes;
+        reporter = progress;
+        endgame.share(stop, id);
+    }
+
+    // At most one of them is set; both nullptr goes back to evaluate(). Only
+    // used on the 8x8 board.
+    void setEvaluator(const PatternEval* patterns, const Network* net)
+    {
+        patternEval = patterns;
+        network = net;
+    }
+
+    // Perfect-play result without a time limit, e.g. for predicting the winner.
+    EndgameResult solve(const Board<N>& root, Disk side)
+    {
+        share(nullptr, 0);
+        return endgame.solve(root, side);
+    }
+
+    SearchResult think(const Board<N>& root, Disk side, const SearchLimits& limits)
+    {
+        auto start = Clock::now();
+        deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(limits.seconds));
+        board = root;
+        nodes = 0;
+        ttProbes = ttHits = ttCutoffs = 0;
+        aborted = false;
+        startTime = start;
+        nextReport = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(PROGRESS_INTERVAL));
+        report = SearchProgress();
+        if constexpr (N == 8) {
+            if (patternEval)
+                PatternEval::init(features, board);
+            if (network)
+                network->init(accumulator, board);
+        }
+
+        SearchResult result;
+        int moves[Board<N>::CELLS];
+        int count = orderedMoves(side, moves);
+        if (count == 0) {
+            result.score = staticEval(side);
+            return result;
+        }
+        if (threadId > 0)
+            std::rotate(moves, moves + threadId % count, moves + count);
+        TranspositionTable::Hit hit;
+        if (tt && tt->probe(board.hash(side), hit))
+            moveToFront(moves, count, hit.move);
+        result.move = moves[0];
+
+        // Near the end the solver gets the whole budget. If it runs out of time,
+        // its move is still the best one proven so far (or its first choice).
+        int emptySquares = board.count(Disk::Empty);
+        bool solving = emptySquares <= limits.exactEmpties;
+        if (solving) {
+            EndgameResult solved = endgame.solve(root, side, deadline);
+            result.move = solved.move;
+            result.exact = solved.exact;
+            result.score = solved.exact ? exactScore(solved.diff) : 0;
+            result.depth = solved.exact ? emptySquares : 0;
+            nodes = solved.nodes;
+        }
+        for (int depth = 1 + threadId % 2; !solving && depth <= limits.maxDepth && depth <= emptySquares; depth++) {
+            int alpha = -INF_SCORE, bestMove = moves[0];
+            for (int i = 0; i < count; i++) {
+                auto undo = play(moves[i], side);
+                int score = -negamax(opponent(side), depth - 1, -INF_SCORE, -alpha, false);
+                unplay(undo);
+                if (aborted)
+                    break;
+                if (score > alpha) {
+                    alpha = score;
+                    bestMove = moves[i];
+                }
+            }
+            if (aborted) {
+                // A better root move found before running out of time is still
+                // safe to play: it was fully searched against the old best.
+                if (bestMove != moves[0]) result.move = bestMove;
+                break;
+            }
+
+            result.move = bestMove;
+            result.score = alpha;
+            result.depth = depth;
+            if (tt)
+                tt->store(board.hash(side), alpha, depth, bestMove, TranspositionTable::EXACT);
+            // Search the best move first in the next iteration
+            moveToFront(moves, count, bestMove);
+            if (reporter) {
+                report.depth = depth;
+                report.score = alpha;
+                principalVariation(side, depth, report.pv);
+                sendReport(Clock::now());
+            }
+
+            double used = std::chrono::duration<double>(Clock::now() - start).count();
+            if (used > limits.seconds / 2 || alpha >= WIN_SCORE || alpha <= -WIN_SCORE)
+                break; // the next iteration would not finish in time, or the result is decided
+        }
+
+        if (stopFlag)
+            stopFlag->store(true, std::memory_order_relaxed); // done: release the other workers
+        result.nodes = nodes;
+        result.ttProbes = ttProbes;
+        result.ttHits = ttHits;
+        result.ttCutoffs = ttCutoffs;
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        return result;
+    }
+
+private:
+    static constexpr int PATTERN_ORDER_DEPTH = 3;
+
+    TranspositionTable* tt;
+    Endgame<N> endgame;
+    Board<N> board;
+    const PatternEval* patternEval = nullptr;
+    const Network* network = nullptr;
+    PatternFeatures features;
+    nnue::Accumulator accumulator;
+    Clock::time_point deadline;
+    uint64_t nodes = 0;
+    uint64_t ttProbes = 0, ttHits = 0, ttCutoffs = 0;
+    bool aborted = false;
+    std::atomic<bool>* stopFlag = nullptr;
+    int threadId = 0;
+    std::atomic<uint64_t>* sharedNodes = nullptr;
+    const ProgressFn* reporter = nullptr;
+    SearchProgress report;
+    Clock::time_point startTime, nextReport;
+
+    // Every 1024 nodes: time, stop flag and progress.
+    void checkpoint()
+    {
+        if (sharedNodes)
+            sharedNodes->fetch_add(1024, std::memory_order_relaxed);
+        auto now = Clock::now();
+        if (now >= deadline || (stopFlag && stopFlag->load(std::memory_order_relaxed)))
+            aborted = true;
+        else if (reporter && now >= nextReport)
+            sendReport(now);
+    }
+
+    void sendReport(Clock::time_point now)
+    {
+        report.nodes = sharedNodes ? sharedNodes->load(std::memory_order_relaxed) + (nodes & 1023) : nodes;
+        report.seconds = std::chrono::duration<double>(now - startTime).count();
+        (*reporter)(report);
+        nextReport = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(PROGRESS_INTERVAL));
+    }
+
+    // Follows the table's best moves from the root, up to `length` plies.
+    void principalVariation(Disk side, int length, std::vector<int>& pv) const
+    {
+        pv.clear();
+        if (!tt)
+            return;
+        Board<N> b = board;
+        TranspositionTable::Hit hit;
+        while ((int)pv.size() < length) {
+            if (!bitboard::any(b.moves(side))) {
+                if (!bitboard::any(b.moves(opponent(side))))
+                    break;
+                pv.push_back(-1);
+                side = opponent(side);
+                continue;
+            }
+            if (!tt->probe(b.hash(side), hit) || hit.move < 0 || !bitboard::test(b.moves(side), hit.move))
+                break;
+            pv.push_back(hit.move);
+            b.play(hit.move, side);
+            side = opponent(side);
+        }
+    }
+
+    static void moveToFront(int* moves, int count, int move)
+    {
+        int* it = std::find(moves, moves + count, move);
+        if (it != moves + count)
+            std::rotate(moves, it, it + 1);
+    }
+
+    typename Board<N>::Undo play(int sq, Disk side)
+    {
+        auto u = board.play(sq, side);
+        if constexpr (N == 8) {
+            if (patternEval)
+                PatternEval::play(features, sq, side, u.flipped);
+            if (network)
+                network->play(accumulator, sq, side, u.flipped);
+        }
+        return u;
+    }
+
+    void unplay(const typename Board<N>::Undo& u)
+    {
+        if constexpr (N == 8) {
+            if (patternEval)
+                PatternEval::undo(features, u.sq, u.who, u.flipped);
+            if (network)
+                network->undo(accumulator, u.sq, u.who, u.flipped);
+        }
+        board.undo(u);
+    }
+
+    int staticEval(Disk side) const
+    {
+        if constexpr (N == 8) {
+            if (patternEval || network) {
+                Disk opp = opponent(side);
+                int own = bitboard::popcount(board.moves(side));
+                int theirs = bitboard::popcount(board.moves(opp));
+                if (own == 0 && theirs == 0)
+                    return finalScore(board, side);
+                int positional = patternEval
+                    ? patternEval->score(features, Board<N>::CELLS - board.count(Disk::Empty), side)
+                    : network->score(accumulator, side);
+                return positional + MOBILITY_WEIGHT * (own - theirs);
+            }
+        }
+        return evaluate(board, side);
+    }
+
+    // Sorts moves by the pattern score of the position they lead to, all
+    // children scored in one scoreBatch call.
+    void orderByPatterns(Disk side, int* moves, int count) const
+    {
+        if constexpr (N == 8) {
+            if (!patternEval || count < 2)
+                return;
+            PatternFeatures children[Board<N>::CELLS];
+            uint8_t phases[Board<N>::CELLS];
+            int32_t scores[Board<N>::CELLS];
+            int phase = patterns::phaseOf(Board<N>::CELLS - board.count(Disk::Empty) + 1);
+            for (int i = 0; i < count; i++) {
+                children[i] = features;
+                PatternEval::play(children[i], moves[i], side, board.flips(moves[i], side));
+                phases[i] = (uint8_t)phase;
+            }
+            patternEval->scoreBatch(children, phases, count, scores);
+
+            int sign = side == Disk::X ? 1 : -1;
+            int order[Board<N>::CELLS];
+            for (int i = 0; i < count; i++)
+                order[i] = i;
+            std::sort(order, order + count, [&](int a, int b) { return sign * scores[a] > sign * scores[b]; });
+            int sorted[Board<N>::CELLS];
+            for (int i = 0; i < count; i++)
+                sorted[i] = moves[order[i]];
+            std::copy(sorted, sorted + count, moves);
+        } else {
+            (void)side; (void)moves; (void)count;
+        }
+    }
+
+    // Legal moves of `side`, best square weights first.
+    int orderedMoves(Disk side, int* out) const
+    {
+        int n = 0;
+        for (Bits m = board.moves(side); bitboard::any(m); )
+            out[n++] = bitboard::popLowest(m);
+        std::sort(out, out + n, [](int a, int b) { return SQUARE_WEIGHTS<N>[a] > SQUARE_WEIGHTS<N>[b]; });
+        return n;
+    }
+
+    int negamax(Disk side, int depth, int alpha, int beta, bool passed)
+    {
+        if ((++nodes & 1023) == 0)
+            checkpoint();
+        if (aborted)
+            return 0;
+
+        if (depth <= 0)
+            return staticEval(side);
+
+        uint64_t key = board.hash(side);
+        int ttMove = -1;
+        if (tt) {
+            TranspositionTable::Hit hit;
+            ttProbes++;
+            if (tt->probe(key, hit)) {
+                ttHits++;
+                ttMove = hit.move;
+                if (hit.depth >= depth &&
+                    (hit.bound == TranspositionTable::EXACT ||
+                     (hit.bound == TranspositionTable::LOWER && hit.score >= beta) ||
+                     (hit.bound == TranspositionTable::UPPER && hit.score <= alpha))) {
+                    ttCutoffs++;
+                    return hit.score;
+                }
+            }
+        }
+
+        int moves[Board<N>::CELLS];
+        int count = orderedMoves(side, moves);
+        if (depth >= PATTERN_ORDER_DEPTH)
+            orderByPatterns(side, moves, count);
+        if (count == 0) {
+            if (passed)
+                return finalScore(board, side);
+            return -negamax(opponent(side), depth, -beta, -alpha, true);
+        }
+        if (ttMove >= 0)
+            moveToFront(moves, count, ttMove);
+
+        int originalAlpha = alpha;
+        int best = -INF_SCORE, bestMove = -1;
+        for (int i = 0; i < count; i++) {
+            auto undo = play(moves[i], side);
+            int score = -negamax(opponent(side), depth - 1, -beta, -alpha, false);
+            unplay(undo);
+            if (aborted)
+                return 0;
+            if (score > best) {
+                best = score;
+                bestMove = moves[i];
+                if (score > alpha) {
+                    alpha = score;
+                    if (alpha >= beta)
+                        break;
+                }
+            }
+        }
+
+        if (tt) {
+            auto bound = best >= beta ? TranspositionTable::LOWER
+                       : best > originalAlpha ? TranspositionTable::EXACT
+                       : TranspositionTable::UPPER;
+            tt->store(key, best, depth, bestMove, bound);
+        }
+        return best;
+    }
+};
+
+enum class EvalKind { SQUARES, PATTERNS, NNUE };
+enum class Algorithm { ALPHA_BETA, MCTS };
+
+// Runtime front end used by Game: forwards to the Search<N> workers matching the
+// board. All board sizes and threads share one transposition table.
+class Engine {
+public:
+    explicit Engine(size_t hashMB = 64, int threads = 1);
+    ~Engine() { stopPonder(); }
+
+    // With several threads the result comes from the worker that completed the
+    // deepest iteration, ties going to the lowest thread id, so the main thread
+    // wins unless a helper got strictly further. `progress` is called from the
+    // main search thread while it runs; raising *stop ends it early with the
+    // best move so far. A position found in the opening book is answered from
+    // it without searching.
+    SearchResult think(const AnyBoard& board, Disk side, const SearchLimits& limits,
+                       const ProgressFn& progress = nullptr, std::atomic<bool>* stop = nullptr);
+    // Exact endgame solve on the main worker, however long it takes.
+    EndgameResult solve(const AnyBoard& board, Disk side);
+
+    // 0 = one thread per core.
+    void setThreads(int threads);
+
+    // Evaluation used by the 8x8 search. Loading a weights or network file also
+    // selects that evaluator; selecting one that was never loaded uses its
+    // built-in weights.
+    bool loadPatterns(const std::string& path, std::string* error = nullptr);
+    bool loadNetwork(const std::string& path, std::string* error = nullptr);
+    void setEvaluator(EvalKind kind);
+    EvalKind evaluator() const { return evalKind; }
+
+    // The file is mapped, not read: loading costs the same for any size of book.
+    bool loadBook(const std::string& path, std::string* error = nullptr);
+
+    // MCTS replaces the alpha-beta search until the exact solver takes over.
+    // Its tree lives in a node pool of `megabytes`, kept between moves and
+    // dropped by newGame().
+    void setAlgorithm(Algorithm a) { stopPonder(); algorithm = a; }
+    Algorithm getAlgorithm() const { return algorithm; }
+    void setTreeSize(size_t megabytes)
+    {
+        stopPonder();
+        if (megabytes != pool.sizeMB())
+            pool.resize(megabytes);
+    }
+    void newGame() { stopPonder(); pool.clear(); }
+
+    // Pondering: while the opponent (`toMove`) thinks, search their position on
+    // background threads. That covers every reply, so the next think() can
+    // answer at once when the position it gets was searched as deep (in plies
+    // from the start of the game) as its own last search went: a transposition
+    // table entry for alpha-beta, subtree visits for MCTS. Otherwise it searches
+    // as usual, starting from the warm table / tree. stopPonder() returns within
+    // about a millisecond; think(), solve() and every setter call it first.
+    void startPonder(const AnyBoard& board, Disk toMove, const SearchLimits& limits);
+    void stopPonder();
+    bool isPondering() const { return ponderThread.joinable(); }
+    int threadCount() const { return (int)search8.size(); }
+
+    void setHashSize(size_t megabytes)
+    {
+        stopPonder();
+        if (megabytes != tt.sizeMB())
+            tt.resize(megabytes);
+    }
+    size_t hashSizeMB() const { return tt.sizeMB(); }
+    void clearHash() { stopPonder(); tt.clear(); }
+
+private:
+    TranspositionTable tt;
+    std::unique_ptr<PatternEval> patternEval;
+    std::unique_ptr<Network> network;
+    std::unique_ptr<OpeningBook> book;
+    EvalKind evalKind = EvalKind::SQUARES;
+    Algorithm algorithm = Algorithm::ALPHA_BETA;
+    NodePool pool;
+    Mcts<8> mcts8{ &pool };
+    Mcts<10> mcts10{ &pool };
+    Mcts<12> mcts12{ &pool };
+    uint64_t mctsSeed = 1;
+
+    std::thread ponderThread;
+    std::atomic<bool> ponderStop{ false };
+    bool pondered = false;          // a ponder ran since the last think()
+    int lastDepth = 0;              // depth of the last alpha-beta search
+    uint64_t lastPlayouts = 0;      // playouts of the last MCTS search
+    std::vector<Search<8>> search8;
+    std::vector<Search<10>> search10;
+    std::vector<Search<12>> search12;
+
+    void applyEvaluator();
+
+    template <int N> bool usesMcts(const Board<N>& b, const SearchLimits& limits) const
+    {
+        return algorithm == Algorithm::MCTS && b.count(Disk::Empty) > limits.exactEmpties;
+    }
+
+    template <int N>
+    bool ponderHit(const Board<N>& b, Disk side, const SearchLimits& limits, SearchResult& out)
+    {
+        if (usesMcts(b, limits)) {
+            if (lastPlayouts == 0 || mctsFor<N>().visitsAt(b, side) < lastPlayouts)
+                return false;
+            SearchLimits none = limits;
+            none.seconds = 0; // just read the best move off the tree
+            out = runMcts<N>(b, side, none);
+            out.pondered = true;
+            return true;
+        }
+
+        TranspositionTable::Hit hit;
+        if (lastDepth == 0 || !tt.probe(b.hash(side), hit) || hit.depth < std::max(1, lastDepth - 2) ||
+            hit.bound == TranspositionTable::UPPER || hit.move < 0 || !bitboard::test(b.moves(side), hit.move))
+            return false;
+        out = SearchResult();
+        out.move = hit.move;
+        out.score = hit.score;
+        out.depth = hit.depth;
+        out.exact = hit.bound == TranspositionTable::EXACT && hit.depth >= b.count(Disk::Empty);
+        out.pondered = true;
+        return true;
+    }
+
+    template <int N> std::vector<Search<N>>& searchFor()
+    {
+        if constexpr (N == 8) return search8;
+        else if constexpr (N == 10) return search10;
+        else return search12;
+    }
+
+    template <int N> Mcts<N>& mctsFor()
+    {
+        if constexpr (N == 8) return mcts8;
+        else if constexpr (N == 10) return mcts10;
+        else return mcts12;
+    }
+
+    template <int N>
+    SearchResult runMcts(const Board<N>& root, Disk side, const SearchLimits& limits,
+                         const std::atomic<bool>* stop = nullptr, const ProgressFn* progress = nullptr)
+    {
+        Mcts<N>& mcts = mctsFor<N>();
+        if (progress) {
+            mcts.setReporter([progress](const MctsResult& m) {
+                SearchProgress p;
+                p.depth = m.depth;
+                p.nodes = m.playouts;
+                p.seconds = m.seconds;
+                p.winRate = m.winRate;
+                p.pv = m.pv;
+                (*progress)(p);
+            });
+        }
+        MctsResult m = mcts.think(root, side, limits.seconds, threadCount(), mctsSeed++, stop);
+        mcts.setReporter(nullptr);
+        SearchResult r;
+        r.move = m.move;
+        r.depth = m.depth;
+        r.nodes = m.playouts;
+        r.seconds = m.seconds;
+        r.winRate = m.winRate;
+        return r;
+    }
+
+    template <int N>
+    SearchResult runThreads(const Board<N>& root, Disk side, const SearchLimits& limits,
+                            std::atomic<bool>* external = nullptr, const ProgressFn* progress = nullptr)
+    {
+        auto& workers = searchFor<N>();
+        std::atomic<bool> local{ false };
+        std::atomic<uint64_t> liveNodes{ 0 };
+        std::atomic<bool>& stop = external ? *external : local;
+        std::vector<SearchResult> results(workers.size());
+        std::vector<std::thread> helpers;
+
+        auto start = std::chrono::steady_clock::now();
+        tt.newSearch();
+        for (size_t i = 0; i < workers.size(); i++)
+            workers[i].share(workers.size() > 1 || external ? &stop : nullptr, (int)i,
+                             progress ? &liveNodes : nullptr, i == 0 ? progress : nullptr);
+        for (size_t i = 1; i < workers.size(); i++)
+            helpers.emplace_back([&, i] { results[i] = workers[i].think(root, side, limits); });
+        results[0] = workers[0].think(root, side, limits);
+        stop = true;
+        for (auto& t : helpers)
+            t.join();
+
+        SearchResult best = results[0];
+        for (size_t i = 1; i < results.size(); i++)
+            if (results[i].depth > best.depth)
+                best = results[i];
+        best.nodes = best.ttProbes = best.ttHits = best.ttCutoffs = 0;
+        for (const auto& r : results) {
+            best.nodes += r.nodes;
+            best.ttProbes += r.ttProbes;
+            best.ttHits += r.ttHits;
+            best.ttCutoffs += r.ttCutoffs;
+        }
+        best.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return best;
+    }
+};
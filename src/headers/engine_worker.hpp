@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "board.hpp"
+#include "engine.hpp"
+
+// Runs the Engine on a thread of its own so the game loop never waits for it.
+// The game posts requests (search, ponder, stop, or any engine call) and polls
+// for responses: progress reports while a search runs, then its result. Every
+// Engine call goes through this thread, one request at a time, so the engine
+// needs no locking of its own.
+class EngineWorker {
+public:
+    struct Response {
+        enum Type { PROGRESS, RESULT };
+        Type type = PROGRESS;
+        uint64_t id = 0;            // search it belongs to, as returned by search()
+        SearchProgress progress;
+        SearchResult result;
+        bool cancelled = false;     // RESULT of a search stopped by stop()
+    };
+
+    explicit EngineWorker(Engine& engine);
+    ~EngineWorker();
+
+    EngineWorker(const EngineWorker&) = delete;
+    EngineWorker& operator=(const EngineWorker&) = delete;
+
+    // Queues a search of a copy of `board`; returns its id.
+    uint64_t search(const AnyBoard& board, Disk side, const SearchLimits& limits);
+    void ponder(const AnyBoard& board, Disk toMove, const SearchLimits& limits);
+
+    // Drops queued searches and ponders and stops the running one; the search
+    // sees the flag within about a millisecond and answers with a cancelled
+    // RESULT. Does not wait.
+    void stop();
+
+    // Runs fn(engine) on the worker after everything queued before it, and
+    // waits for it.
+    void call(const std::function<void(Engine&)>& fn);
+
+    // Next response, false when there is none. Progress reports of one search
+    // are merged, so a slow reader only sees the latest.
+    bool poll(Response& out);
+
+    // An eventfd that turns readable when a response is queued, for poll().
+    // Reading it (8 bytes) resets it; poll() above does not.
+    int notifyFd() const { return eventFd; }
+
+private:
+    struct Request {
+        enum Type { SEARCH, PONDER, STOP, CALL, QUIT };
+        Type type = STOP;
+        uint64_t id = 0;
+        AnyBoard board{ 8 };
+        Disk side = Disk::X;
+        SearchLimits limits;
+        std::function<void(Engine&)> fn;
+    };
+
+    Engine& engine;
+    std::mutex queueMutex;
+    std::condition_variable wake;
+    std::condition_variable called;
+    std::deque<Request> requests;
+    std::deque<Response> responses;
+    uint64_t nextId = 0;
+    uint64_t callsDone = 0;
+    uint64_t callsQueued = 0;
+    uint64_t running = 0;           // id of the search in progress, 0 when idle
+    bool cancelled = false;
+    std::atomic<bool> stopFlag{ false };
+    int eventFd = -1;
+    std::thread thread;
+
+    void loop();
+    void runSearch(const Request& r);
+    void respond(Response r);
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+
+#include "board.hpp"
+
+// Static evaluation for the search: square weights plus mobility, from the point
+// of view of `side`. Midgame scores stay within a few thousand; finished games
+// score WIN_SCORE + disc difference so any win beats any heuristic value.
+constexpr int WIN_SCORE = 1000000;
+constexpr int INF_SCORE = 2 * WIN_SCORE;
+constexpr int MOBILITY_WEIGHT = 8;  // per legal move more than the opponent
+
+// Search-scale score of a finished game won by `diff` discs, and back.
+constexpr int exactScore(int diff)
+{
+    return diff > 0 ? WIN_SCORE + diff : diff < 0 ? -WIN_SCORE + diff : 0;
+}
+
+constexpr int discDifference(int score)
+{
+    return score > WIN_SCORE ? score - WIN_SCORE : score < -WIN_SCORE ? score + WIN_SCORE : 0;
+}
+
+template <int N>
+int finalScore(const Board<N>& b, Disk side)
+{
+    return exactScore(b.count(side) - b.count(opponent(side)));
+}
+
+template <int N>
+constexpr std::array<int, N * N> makeSquareWeights()
+{
+    std::array<int, N * N> w{};
+    for (int sq = 0; sq < N * N; sq++) {
+        int x = sq % N, y = sq / N;
+        int ex = x < N - 1 - x ? x : N - 1 - x; // distance to the nearest vertical edge
+        int ey = y < N - 1 - y ? y : N - 1 - y;
+
+        if (ex == 0 && ey == 0) w[sq] = 100;                            // corner
+        else if (ex == 1 && ey == 1) w[sq] = -50;                       // X-square
+        else if ((ex == 0 && ey == 1) || (ex == 1 && ey == 0)) w[sq] = -20; // C-square
+        else if (ex == 0 || ey == 0) w[sq] = 10;                        // edge
+        else if (ex == 1 || ey == 1) w[sq] = -5;                        // next to an edge
+        else w[sq] = 1;
+    }
+    return w;
+}
+
+template <int N>
+constexpr std::array<int, N * N> SQUARE_WEIGHTS = makeSquareWeights<N>();
+
+template <int N>
+int squareScore(const typename Board<N>::Bits& discs)
+{
+    int s = 0;
+    for (auto b = discs; bitboard::any(b); )
+        s += SQUARE_WEIGHTS<N>[bitboard::popLowest(b)];
+    return s;
+}
+
+template <int N>
+int evaluate(const Board<N>& b, Disk side)
+{
+    Disk opp = opponent(side);
+    int own = bitboard::popcount(b.moves(side));
+    int theirs = bitboard::popcount(b.moves(opp));
+    if (own == 0 && theirs == 0)
+        return finalScore(b, side);
+    return squareScore<N>(b.discs(side)) - squareScore<N>(b.discs(opp)) + MOBILITY_WEIGHT * (own - theirs);
+}
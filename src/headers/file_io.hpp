@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstddef>
+
+// write() until all of `data` is out, through short writes and EINTR. False
+// on any other error (errno is left set).
+bool writeAll(int fd, const void* data, size_t size);
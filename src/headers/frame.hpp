@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "color.hpp"
+
+// One character cell of the screen: a code point (every glyph the game uses
+// is one column wide) and the foreground colour it is drawn in.
+struct Cell {
+    uint32_t ch = ' ';
+    uint8_t color = DEFAULT;
+
+    bool operator==(const Cell& o) const { return ch == o.ch && color == o.color; }
+    bool operator!=(const Cell& o) const { return !(*this == o); }
+};
+
+// Retained screen model. The renderer draws a whole frame into one of these
+// with the same calls it used on the terminal (moveTo for move_cursor,
+// setColor for setTextColor, << for cout), then compares it with the frame
+// the terminal already shows and sends only the cells that changed.
+// Coordinates are 1-based columns / rows like move_cursor; anything drawn
+// outside the frame is dropped.
+class Frame {
+public:
+    void resize(int cols, int rows);
+    int width() const { return cols; }
+    int height() const { return rows; }
+
+    // Blank cells in the default colour; the pen goes to the top-left corner.
+    void clear();
+    // The same for the width x height cells from (x, y) only.
+    void clear(int x, int y, int width, int height);
+    // Another frame's cells (of the same size), to redraw only part of it.
+    void copyCells(const Frame& other) { cells = other.cells; }
+
+    void moveTo(int x, int y) { penX = x; penY = y; }
+    void setColor(TextColor color) { pen = (uint8_t)color; }
+    void resetColor() { pen = DEFAULT; }
+
+    // UTF-8 text at the pen; '\n' goes to the start of the next row.
+    Frame& operator<<(const char* text);
+    Frame& operator<<(const std::string& text) { return *this << text.c_str(); }
+    Frame& operator<<(char c);
+    Frame& operator<<(int n) { return *this << std::to_string(n); }
+
+    // `text` left-aligned in `width` cells: padded with blanks or cut short.
+    void field(const std::string& text, int width);
+
+    // 0-based cell access for the diff.
+    const Cell& at(int x, int y) const { return cells[y * cols + x]; }
+
+private:
+    int cols = 0, rows = 0;
+    std::vector<Cell> cells;
+    int penX = 1, penY = 1;
+    uint8_t pen = DEFAULT;
+
+    void put(uint32_t ch);
+};
+
+// UTF-8 encoding of one code point; returns the byte count (1..4).
+int encodeUtf8(uint32_t ch, char* out);
+
+// Terminal output of one frame, assembled in a buffer allocated once. It
+// knows the colour and cursor position the terminal will have after what was
+// appended so far, drops escapes that would not change them and picks the
+// shortest cursor move; flush() sends everything with a single write(2).
+class FrameOutput {
+public:
+    explicit FrameOutput(size_t capacity = 64 * 1024);
+
+    void clearScreen();
+    void moveTo(int x, int y);                      // 1-based, like move_cursor
+    int moveCost(int x, int y) const;               // bytes moveTo(x, y) would add
+    void setColor(uint8_t color);
+    void glyph(uint32_t ch);                        // at the cursor, which moves right
+
+    int cursorX() const { return x; }
+    int cursorY() const { return y; }
+    int color() const { return pen; }
+
+    // Writes the buffer out; returns the byte count.
+    size_t flush();
+
+    // Someone else wrote to the terminal: assume nothing about its state.
+    void forget() { x = y = pen = -1; }
+
+private:
+    std::vector<char> buf;
+    size_t used = 0;
+    int x = -1, y = -1;     // -1: unknown
+    int pen = -1;
+
+    void append(const char* s, size_t n);
+    void appendNumber(int n);
+};
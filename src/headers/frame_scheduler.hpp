@@ -0,0 +1,32 @@
+#pragma once
+
+#include <chrono>
+
+// Decides when the game loop draws. Events mark the screen regions they
+// change (Renderer::Region); a frame is due once something is dirty and a
+// display interval has passed since the last one. A burst of events (a held
+// arrow key, engine progress) therefore becomes one frame with all of its
+// changes, and nothing is drawn while nothing changes.
+class FrameScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr int DEFAULT_RATE = 60;     // frames per second at most
+
+    explicit FrameScheduler(int hz = DEFAULT_RATE) { setRate(hz); }
+    void setRate(int hz);
+
+    void mark(unsigned regions) { dirty |= regions; }
+
+    // Milliseconds until the next frame is due, for poll(): -1 when nothing
+    // is dirty, 0 when it is due now.
+    int timeout(Clock::time_point now) const;
+
+    // The dirty regions when a frame is due now (they count as drawn from
+    // here on), otherwise 0.
+    unsigned take(Clock::time_point now);
+
+private:
+    Clock::duration interval;
+    Clock::time_point last;     // when the last frame was taken
+    unsigned dirty = 0;
+};
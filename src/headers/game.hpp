@@ -4,27 +4,86 @@
 #include <chrono>
 
 #include "board.hpp"
+#include "engine.hpp"
+#include "engine_worker.hpp"
+#include "frame_scheduler.hpp"
+#include "game_db.hpp"
+#include "game_record.hpp"
 #include "renderer.hpp"
+#include "terminal.hpp"
 #include "cursor_input.hpp"
 #include "utils.hpp"
 
 class Game {
-    Board* board;
+    AnyBoard* board;
     Renderer renderer;
-    Board::Disk turn;
+    EventLoop events;
+    FrameScheduler frames;
+    Disk turn;
     int cursorX;
     int cursorY;
     std::vector<MoveRecord> moveHistory;
     std::chrono::steady_clock::time_point startTime;
+    std::chrono::steady_clock::time_point turnStart;   // of the side to move
+    uint32_t clockMs[2] = { 0, 0 };     // time each side took, X then O
+    GameLog log;                        // --record: every move as it is made
+    GameDb db;                          // --db: how the legal moves fared
     bool isRunning;
     int boardSize;
 
+    Engine engine;
+    EngineWorker worker{ engine };  // all engine work once the game runs
+    bool computerPlays[2];      // indexed by side: 0 = X (●), 1 = O (○)
+    SearchLimits engineLimits;  // seconds: the average per move, see moveLimits()
+    SearchResult lastSearch;
+    Disk lastSearchSide;
+    uint64_t searchId = 0;      // search the game waits for, 0 when none
+    SearchProgress thinking;    // its latest progress report
+    bool pondering = false;
+
+    // What a move (or taking one back) changes on screen
+    static constexpr unsigned MOVE_REGIONS =
+        Renderer::BOARD | Renderer::SCORE | Renderer::HISTORY | Renderer::STATUS;
+
+    bool isComputer(Disk side) const { return computerPlays[side == Disk::X ? 0 : 1]; }
+    bool choosePlayers();
+    void draw(unsigned regions);    // into the renderer's frame; present() sends it
+    void handleKey(InputKey key);
+    void settleTurn();
+    void pollEngine();
+    void playEngineMove(const SearchResult& result);
+    void stopEngine();
+    void clearGame();
+    bool resumeGame();
+    void chargeClock(Disk side);
+    SearchLimits moveLimits() const;
+    void recordMove(Disk side, int square);
+    std::string engineInfo() const;
+
 public:
     Game();
     ~Game();
+    // Settings go straight to the engine: they are made before run(), while
+    // the worker has nothing to do.
+    void setHashSize(size_t megabytes) { engine.setHashSize(megabytes); }
+    void setThreads(int threads) { engine.setThreads(threads); }
+    void setExactEmpties(int empties) { engineLimits.exactEmpties = empties; }
+    bool loadPatterns(const std::string& path, std::string* error) { return engine.loadPatterns(path, error); }
+    bool loadNetwork(const std::string& path, std::string* error) { return engine.loadNetwork(path, error); }
+    bool loadBook(const std::string& path, std::string* error) { return engine.loadBook(path, error); }
+    void setEvaluator(EvalKind kind) { engine.setEvaluator(kind); }
+    void setAlgorithm(Algorithm a) { engine.setAlgorithm(a); }
+    void setTreeSize(size_t megabytes) { engine.setTreeSize(megabytes); }
+    void setFrameRate(int hz) { frames.setRate(hz); }
+    // Appends the games to a log; one left unfinished there is resumed.
+    bool openRecord(const std::string& path, std::string* error) { return log.open(path, error); }
+    // Shows the database's statistics for the legal moves next to the history.
+    bool openDatabase(const std::string& path, std::string* error) { return db.open(path, error); }
     void run();
+    const Renderer::Stats& frameStats() const { return renderer.frameStats(); }
     void showMenu();
     void resetGame();
+    void undoMove();
     int getElapsedSeconds() const;
     // Show winner message. If posX/posY >= 0 they specify the column,row to print the message.
     void isWinner(int posX = -1, int posY = -1);
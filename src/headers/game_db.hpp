@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "board.hpp"
+
+// Position index over a collection of games: for every position reached in
+// them (by its symmetry-canonical key, with the side that just moved), how
+// many games went through it and how they ended. The win rate of a legal
+// move is read from the position it leads to, so transpositions and
+// symmetric moves count together.
+//
+// The file is memory-mapped and looked up in place: a header, a directory of
+// PARTITIONS open-addressing tables chosen by the top bits of the key, and
+// the tables. Opening it costs nothing but the mmap, and a lookup is one
+// probe sequence in one table, a microsecond or less even on a cold page.
+struct DbSlot {
+    uint64_t key;       // 0: empty slot
+    uint32_t games;
+    uint32_t points;    // X's points, 2 for a win and 1 for a draw
+};
+
+// Database statistics for one legal move, from the mover's point of view.
+struct MoveStats {
+    int x, y;
+    uint32_t games;
+    double score;       // 1 is a sure win, 0.5 even
+};
+
+class GameDb {
+public:
+    static constexpr int PARTITION_BITS = 8;
+    static constexpr int PARTITIONS = 1 << PARTITION_BITS;
+
+    GameDb() = default;
+    ~GameDb();
+
+    GameDb(const GameDb&) = delete;
+    GameDb& operator=(const GameDb&) = delete;
+
+    bool open(const std::string& path, std::string* error = nullptr);
+    bool isOpen() const { return base != nullptr; }
+    void close();
+
+    const DbSlot* find(uint64_t key) const;
+
+    // The legal moves of `side` that the database has seen played here,
+    // most played first.
+    std::vector<MoveStats> moveStats(const AnyBoard& board, Disk side) const;
+
+    uint64_t games() const;
+    uint64_t positions() const;     // distinct
+
+private:
+    const uint8_t* base = nullptr;
+    size_t length = 0;
+};
+
+// Builds a database from WTHOR archives (.wtb, 8x8) and game logs
+// (game_record.hpp); each file's format is told by its header.
+struct DbBuildStats {
+    uint64_t games = 0;
+    uint64_t positions = 0;         // positions replayed
+    uint64_t distinct = 0;
+    uint64_t skipped = 0;           // unfinished or unreadable games
+    double seconds = 0;
+};
+
+// Every input is mapped and cut into jobs that `threads` workers replay in
+// parallel. Each worker sorts its positions into the partitions as it goes
+// and hands full buffers over to be merged, so memory follows the number of
+// distinct positions rather than the size of the input. `progress` (which
+// may be empty) is called now and then from one of the workers.
+bool buildGameDb(const std::vector<std::string>& inputs, const std::string& output, int threads,
+                 DbBuildStats& stats, std::string* error = nullptr,
+                 const std::function<void(const DbBuildStats&)>& progress = nullptr);
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Game log: games stored back to back, a byte per move, appended while they
+// are played.
+//
+//   file   "OTHLOG1\n", then the games
+//   game   START size players          size 8/10/12; players bit 0: X is the
+//                                      computer, bit 1: O is
+//          a byte per move             the square y * size + x, or PASS;
+//                                      UNDO takes back the last move (and
+//                                      the passes after it)
+//          CLOCK clocks(10)            time each side took so far: every
+//                                      CLOCK_MOVES moves and on quitting, in
+//                                      games played at the terminal
+//          END clocks(10) discs(2)     time each side took in milliseconds,
+//                                      five 7-bit bytes per side, low first;
+//                                      final disc counts of X and O
+//       or ABANDON                     left before the end (a new game)
+//
+// Tags are 0xF0 and up and nothing else is, payloads included, so a record
+// boundary is found by scanning in either direction. A game without END or
+// ABANDON is the one in progress: reopening the log only has to walk back
+// over its moves to resume it, whatever the size of the file.
+namespace record {
+
+constexpr uint8_t START = 0xF0;
+constexpr uint8_t END = 0xF1;
+constexpr uint8_t ABANDON = 0xF2;
+constexpr uint8_t CLOCK = 0xF3;
+constexpr uint8_t UNDO = 0xFC;
+constexpr uint8_t PASS = 0xFF;
+
+constexpr size_t MAGIC_SIZE = 8;
+constexpr size_t START_SIZE = 3;
+constexpr size_t END_SIZE = 13;
+constexpr size_t CLOCK_SIZE = 11;
+constexpr size_t CLOCK_MOVES = 16;     // moves between two CLOCK records
+
+} // namespace record
+
+struct GameRecord {
+    enum Status : uint8_t { PLAYING, FINISHED, ABANDONED };
+
+    int boardSize = 8;
+    uint8_t players = 0;
+    std::vector<uint8_t> moves;     // squares and PASS, with undos applied
+    Status status = PLAYING;
+    uint32_t clockMs[2] = { 0, 0 }; // X, O; set by CLOCK and END
+    int discs[2] = { 0, 0 };
+};
+
+// Reads the games in a log held in memory (a buffer or a mapped file),
+// starting after the magic.
+class GameLogReader {
+public:
+    GameLogReader(const uint8_t* data, size_t size, size_t start = record::MAGIC_SIZE)
+        : data(data), size(size), pos(start) {}
+
+    // The next game; false at the end of the data or at a malformed record
+    // (then error() is set). The game's vector is reused.
+    bool next(GameRecord& game);
+
+    size_t offset() const { return pos; }
+    const char* error() const { return failure; }
+
+    static bool hasMagic(const uint8_t* data, size_t size);
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    const char* failure = nullptr;
+};
+
+// Appends games to a log file as they are played. Each call writes its bytes
+// out (or, with a batch size, once that many are buffered), so quitting or
+// crashing the game keeps everything played. fdatasync runs with the first
+// write after a sync interval has passed: a move every few seconds is synced
+// as it is made, while a batch of generated games shares one sync.
+class GameLog {
+public:
+    GameLog() = default;
+    ~GameLog();
+
+    GameLog(const GameLog&) = delete;
+    GameLog& operator=(const GameLog&) = delete;
+
+    // Opens or creates the log. A record cut off by a crash is dropped; a
+    // game still in progress is loaded for unfinished() and further calls
+    // continue it.
+    bool open(const std::string& path, std::string* error = nullptr);
+    bool isOpen() const { return fd >= 0; }
+    void close();
+
+    // Bytes buffered before a write (0: write every call) and the shortest
+    // time between two fdatasyncs.
+    void setBatch(size_t bytes, double syncSeconds);
+
+    // The game found in progress by open(), until another one begins.
+    const GameRecord* unfinished() const { return resumable ? &resumed : nullptr; }
+
+    void beginGame(int boardSize, uint8_t players);
+    void move(int square);          // or record::PASS
+    void undo();
+    void clocks(const uint32_t clockMs[2]);     // of the game in progress
+    void endGame(const uint32_t clockMs[2], int discsX, int discsO);
+    void abandonGame();
+    // A whole game in one append, e.g. from a self-play worker; one that is
+    // not FINISHED is written as abandoned.
+    void appendGame(const GameRecord& game);
+
+    void flush();                   // write the buffer
+    void sync();                    // and fdatasync
+
+private:
+    void append(const uint8_t* bytes, size_t n);
+    bool recover();
+
+    int fd = -1;
+    bool inGame = false;
+    bool resumable = false;
+    GameRecord resumed;
+    std::vector<uint8_t> buffer;
+    size_t batchBytes = 0;
+    std::chrono::steady_clock::duration syncInterval = std::chrono::milliseconds(200);
+    std::chrono::steady_clock::time_point lastSync;
+    bool unsynced = false;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+// Screen geometry of the game: where the board, side panel and messages go
+// for a terminal of cols x rows. Computed once per terminal size (and board
+// size), not per frame.
+//
+// It tries, in order: the full-size board with the title and the panel on its
+// right; the same without the title; compact cells (one column, no grid lines
+// between them) with and without the title; then the panel below the board.
+// The history box shrinks from ten moves to three before a layout is
+// rejected. When nothing fits, the smallest one is used and the rest is cut
+// off at the terminal's edge. The database box (--db) goes right of the
+// history when there is room for it, and is left out otherwise.
+struct Layout {
+    static constexpr int PANEL_WIDTH = 39;
+    static constexpr int DATABASE_WIDTH = 23;
+
+    int cols = 0, rows = 0, boardSize = 0;  // what the layout was computed for
+
+    bool title = true;          // ASCII-art title above the board
+    bool compact = false;
+    int boardLeft = 4, boardTop = 10;       // top-left corner of the board frame
+    int boardWidth = 0, boardHeight = 0;    // including the frame
+    int menuX = 0, menuY = 0;
+    int historyRows = 10;
+    bool database = false;
+    int databaseX = 0;                      // on the history's rows
+    int instructionsY = 0;
+    int messageX = 0, messageY = 0;         // two lines for the end of the game
+
+    // Terminal column / row of the first character of cell (x, y): " ● " or
+    // "[●]" on the full board, the '[' / ' ' before the disc on compact ones.
+    int cellX(int x) const { return boardLeft + (compact ? 2 * x : 1 + 4 * x); }
+    int cellY(int y) const { return boardTop + 1 + (compact ? y : 2 * y); }
+
+    static Layout compute(int cols, int rows, int boardSize);
+};
@@ -0,0 +1,417 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "board.hpp"
+#include "xoshiro.hpp"
+
+// Monte Carlo tree search: UCT with random playouts, tree-parallel.
+//
+// Every thread walks the same tree. On the way down it bumps the visit count
+// of each node before the result is known (a virtual loss: the node looks like
+// a loss until the playout backs up), which pushes the other threads onto
+// different lines. Statistics are relaxed atomics; a node is expanded by the
+// one thread that wins a compare-exchange on its state, and all of its
+// children are taken from the node pool as one block.
+//
+// The pool is a flat array handed out by a bump pointer: there is no per-node
+// new/delete, and clear() forgets every tree at once. After a move the subtree
+// of the position actually reached becomes the new root and keeps its counts.
+
+namespace mcts {
+
+constexpr uint8_t PASS = 0xFF;
+
+struct Node {
+    std::atomic<uint32_t> visits{ 0 };
+    std::atomic<uint32_t> score{ 0 };       // 2 per win, 1 per draw, for the side that moved into the node
+    std::atomic<uint32_t> firstChild{ 0 };
+    std::atomic<uint8_t> state{ 0 };
+    uint8_t childCount = 0;
+    uint8_t move = PASS;                    // square played to reach the node, or PASS
+
+    enum : uint8_t { LEAF, EXPANDING, EXPANDED };
+};
+
+} // namespace mcts
+
+class NodePool {
+public:
+    static constexpr uint32_t NONE = 0;     // index 0 is never handed out
+
+    explicit NodePool(size_t megabytes = 128) : megabytes(megabytes) {}
+
+    // Memory is only taken on first use, so a game that never runs MCTS does
+    // not pay for it.
+    void resize(size_t megabytes);
+    size_t sizeMB() const { return megabytes; }
+
+    // Forgets every node in O(1). Nodes are re-initialised when handed out again.
+    void clear()
+    {
+        used.store(1, std::memory_order_relaxed);
+        generation++;
+    }
+
+    // First of `count` consecutive nodes, or NONE when the pool is full. The
+    // caller initialises them.
+    uint32_t allocate(uint32_t count);
+
+    mcts::Node& operator[](uint32_t i) { return nodes[i]; }
+    const mcts::Node& operator[](uint32_t i) const { return nodes[i]; }
+
+    size_t capacity() const { return cap; }
+    size_t size() const { return std::min<size_t>(used.load(std::memory_order_relaxed), cap); }
+    // Changes on every clear(), so a tree can tell whether it is still there.
+    uint64_t epoch() const { return generation; }
+    // Allocates the nodes if that has not happened yet.
+    void reserve();
+
+private:
+    size_t megabytes;
+    std::unique_ptr<mcts::Node[]> nodes;
+    size_t cap = 0;
+    std::atomic<uint32_t> used{ 1 };
+    uint64_t generation = 0;
+};
+
+struct MctsResult {
+    int move = -1;          // most visited root move, -1 when the side must pass
+    double winRate = 0;     // expected result of that move for the mover, 0..1
+    uint64_t playouts = 0;
+    uint64_t reused = 0;    // visits already in the subtree kept from the last search
+    int depth = 0;          // deepest tree node reached
+    double seconds = 0;
+    size_t treeNodes = 0;
+    std::vector<int> pv;    // most visited line from the root, PASS as -1
+};
+
+template <int N>
+class Mcts {
+public:
+    using Bits = typename Board<N>::Bits;
+    using Clock = std::chrono::steady_clock;
+
+    using Report = std::function<void(const MctsResult&)>;
+
+    explicit Mcts(NodePool* pool) : pool(pool) {}
+
+    // Called by the main thread every REPORT_INTERVAL of the next think()s with
+    // the result so far; an empty function turns reporting off.
+    void setReporter(Report fn) { reporter = std::move(fn); }
+
+    // Runs `threads` threads until the time is up or *stop is set.
+    MctsResult think(const Board<N>& root, Disk side, double seconds, int threads,
+                     uint64_t seed, const std::atomic<bool>* stop = nullptr)
+    {
+        auto start = Clock::now();
+        deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        external = stop;
+        finished.store(false, std::memory_order_relaxed);
+        playouts.store(0, std::memory_order_relaxed);
+        maxDepth.store(0, std::memory_order_relaxed);
+
+        pool->reserve();
+        MctsResult result;
+        result.reused = setRoot(root, side);
+
+        Node& r = (*pool)[rootIndex];
+        expand(r, rootOwn, rootOpp);
+        if (r.state.load(std::memory_order_acquire) != Node::EXPANDED || r.childCount == 0 ||
+            (*pool)[r.firstChild.load(std::memory_order_relaxed)].move == mcts::PASS) {
+            result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            return result; // pass or game over: nothing to choose
+        }
+
+        std::vector<std::thread> helpers;
+        for (int i = 1; i < threads; i++)
+            helpers.emplace_back([this, seed, i, start] { work(seed + i, false, start); });
+        work(seed, (bool)reporter, start);
+        for (auto& t : helpers)
+            t.join();
+
+        MctsResult done = snapshot(start);
+        done.reused = result.reused;
+        return done;
+    }
+
+    // Visits already spent on `board` in the current tree, 0 when it is not there.
+    uint64_t visitsAt(const Board<N>& board, Disk side)
+    {
+        if (epoch != pool->epoch())
+            return 0;
+        uint32_t found = find(rootIndex, rootBoard, rootSide, board, side, 3);
+        return found == NodePool::NONE ? 0 : (*pool)[found].visits.load(std::memory_order_relaxed);
+    }
+
+private:
+    using Node = mcts::Node;
+
+    static constexpr double EXPLORATION = 0.7;  // UCT constant for results in 0..1
+    static constexpr uint32_t EXPAND_AFTER = 1; // visits a leaf gets before it is expanded
+    static constexpr int MAX_PATH = Board<N>::CELLS * 2 + 2;
+    static constexpr int CHECK_EVERY = 16;      // playouts between clock reads
+    static constexpr double REPORT_INTERVAL = 0.1;
+    static constexpr int PV_LENGTH = 12;
+
+    NodePool* pool;
+    uint64_t epoch = ~0ULL;     // pool epoch the tree belongs to
+    uint32_t rootIndex = NodePool::NONE;
+    Board<N> rootBoard{ false };
+    Disk rootSide = Disk::X;
+    Bits rootOwn{}, rootOpp{};
+
+    Clock::time_point deadline;
+    const std::atomic<bool>* external = nullptr;
+    std::atomic<bool> finished{ false };
+    std::atomic<uint64_t> playouts{ 0 };
+    std::atomic<int> maxDepth{ 0 };
+    Report reporter;
+
+    // Best root move and its line as the tree stands; safe while other threads
+    // keep searching since only expanded nodes are followed.
+    MctsResult snapshot(Clock::time_point start) const
+    {
+        MctsResult result;
+        uint32_t index = rootIndex;
+        while ((int)result.pv.size() < PV_LENGTH) {
+            const Node& n = (*pool)[index];
+            if (n.state.load(std::memory_order_acquire) != Node::EXPANDED || n.childCount == 0)
+                break;
+            uint32_t first = n.firstChild.load(std::memory_order_relaxed);
+            uint32_t best = first;
+            for (uint32_t c = first; c < first + n.childCount; c++)
+                if ((*pool)[c].visits.load(std::memory_order_relaxed) > (*pool)[best].visits.load(std::memory_order_relaxed))
+                    best = c;
+            const Node& b = (*pool)[best];
+            uint32_t v = b.visits.load(std::memory_order_relaxed);
+            if (index == rootIndex) {
+                result.move = b.move;
+                result.winRate = v ? b.score.load(std::memory_order_relaxed) / (2.0 * v) : 0.5;
+            }
+            if (v == 0)
+                break;
+            result.pv.push_back(b.move == mcts::PASS ? -1 : b.move);
+            index = best;
+        }
+        result.playouts = playouts.load(std::memory_order_relaxed);
+        result.depth = maxDepth.load(std::memory_order_relaxed);
+        result.treeNodes = pool->size();
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        return result;
+    }
+
+    static bool sameBoard(const Board<N>& a, const Board<N>& b)
+    {
+        return a.hash() == b.hash() && !bitboard::any(a.discs(Disk::X) ^ b.discs(Disk::X)) &&
+               !bitboard::any(a.discs(Disk::O) ^ b.discs(Disk::O));
+    }
+
+    // Looks for the new root among the nodes up to three plies below the old
+    // one (our move, a reply, a pass); starts a fresh tree when it is not
+    // there or the pool is mostly used up. Returns the visits kept.
+    uint64_t setRoot(const Board<N>& board, Disk side)
+    {
+        uint32_t found = NodePool::NONE;
+        if (epoch == pool->epoch() && pool->size() < pool->capacity() * 3 / 4)
+            found = find(rootIndex, rootBoard, rootSide, board, side, 3);
+
+        if (found == NodePool::NONE) {
+            pool->clear();
+            epoch = pool->epoch();
+            found = pool->allocate(1);
+            init((*pool)[found], mcts::PASS);
+        }
+        rootIndex = found;
+        rootBoard = board;
+        rootSide = side;
+        rootOwn = board.discs(side);
+        rootOpp = board.discs(opponent(side));
+        return (*pool)[found].visits.load(std::memory_order_relaxed);
+    }
+
+    uint32_t find(uint32_t index, const Board<N>& at, Disk toMove, const Board<N>& target, Disk side, int plies)
+    {
+        if (toMove == side && sameBoard(at, target))
+            return index;
+        const Node& n = (*pool)[index];
+        if (plies == 0 || n.state.load(std::memory_order_acquire) != Node::EXPANDED)
+            return NodePool::NONE;
+        uint32_t first = n.firstChild.load(std::memory_order_relaxed);
+        for (uint32_t c = first; c < first + n.childCount; c++) {
+            Board<N> next = at;
+            uint8_t move = (*pool)[c].move;
+            if (move != mcts::PASS)
+                next.play(move, toMove);
+            uint32_t hit = find(c, next, opponent(toMove), target, side, plies - 1);
+            if (hit != NodePool::NONE)
+                return hit;
+        }
+        return NodePool::NONE;
+    }
+
+    static void init(Node& n, uint8_t move)
+    {
+        n.visits.store(0, std::memory_order_relaxed);
+        n.score.store(0, std::memory_order_relaxed);
+        n.firstChild.store(NodePool::NONE, std::memory_order_relaxed);
+        n.state.store(Node::LEAF, std::memory_order_relaxed);
+        n.childCount = 0;
+        n.move = move;
+    }
+
+    // Gives the node its children (one per legal move, or a single pass).
+    // Only the thread that wins the state change does the work; a full pool
+    // leaves the node a leaf.
+    bool expand(Node& n, const Bits& own, const Bits& opp)
+    {
+        uint8_t expected = Node::LEAF;
+        if (!n.state.compare_exchange_strong(expected, Node::EXPANDING, std::memory_order_acquire))
+            return false;
+
+        Bits moves = BoardBits<N>::moves(own, opp);
+        uint32_t count = bitboard::popcount(moves);
+        bool pass = count == 0 && bitboard::any(BoardBits<N>::moves(opp, own));
+        if (pass)
+            count = 1;
+
+        uint32_t first = NodePool::NONE;
+        if (count > 0) {
+            first = pool->allocate(count);
+            if (first == NodePool::NONE) {
+                n.state.store(Node::LEAF, std::memory_order_release);
+                return false;
+            }
+            for (uint32_t i = 0; i < count; i++)
+                init((*pool)[first + i], pass ? mcts::PASS : (uint8_t)bitboard::popLowest(moves));
+        }
+        n.childCount = (uint8_t)count;
+        n.firstChild.store(first, std::memory_order_relaxed);
+        n.state.store(Node::EXPANDED, std::memory_order_release);
+        return true;
+    }
+
+    uint32_t select(const Node& n) const
+    {
+        uint32_t first = n.firstChild.load(std::memory_order_relaxed);
+        double scale = EXPLORATION * std::sqrt(std::log((double)n.visits.load(std::memory_order_relaxed) + 1));
+        uint32_t best = first;
+        double bestValue = -1;
+        for (uint32_t c = first; c < first + n.childCount; c++) {
+            const Node& child = (*pool)[c];
+            uint32_t v = child.visits.load(std::memory_order_relaxed);
+            if (v == 0)
+                return c;
+            double value = child.score.load(std::memory_order_relaxed) / (2.0 * v) + scale / std::sqrt((double)v);
+            if (value > bestValue) {
+                bestValue = value;
+                best = c;
+            }
+        }
+        return best;
+    }
+
+    // Plays random moves to the end; returns the disc difference for `own`.
+    static int playout(const Bits& start, const Bits& startOpp, Xoshiro256& rng)
+    {
+        Bits own = start, opp = startOpp;
+        bool swapped = false;
+        for (;;) {
+            Bits moves = BoardBits<N>::moves(own, opp);
+            if (!bitboard::any(moves)) {
+                if (!bitboard::any(BoardBits<N>::moves(opp, own)))
+                    break;
+                std::swap(own, opp);
+                swapped = !swapped;
+                continue;
+            }
+            for (uint32_t skip = rng.below(bitboard::popcount(moves)); skip > 0; skip--)
+                bitboard::popLowest(moves);
+            int sq = bitboard::popLowest(moves);
+            Bits flipped = BoardBits<N>::flips(sq, own, opp);
+            own = own | flipped | bitboard::squareBit<Bits>(sq);
+            opp = opp ^ flipped;
+            std::swap(own, opp);
+            swapped = !swapped;
+        }
+        int diff = bitboard::popcount(own) - bitboard::popcount(opp);
+        return swapped ? -diff : diff;
+    }
+
+    // One selection / expansion / playout / backup pass.
+    void iterate(Xoshiro256& rng, uint32_t* path)
+    {
+        Bits own = rootOwn, opp = rootOpp;
+        int len = 0;
+        uint32_t index = rootIndex;
+        path[len++] = index;
+        (*pool)[index].visits.fetch_add(1, std::memory_order_relaxed);
+
+        for (;;) {
+            Node& n = (*pool)[index];
+            if (n.state.load(std::memory_order_acquire) != Node::EXPANDED) {
+                if (n.visits.load(std::memory_order_relaxed) <= EXPAND_AFTER || !expand(n, own, opp))
+                    break;
+            }
+            if (n.childCount == 0 || len == MAX_PATH)
+                break; // game over
+            index = select(n);
+            Node& child = (*pool)[index];
+            child.visits.fetch_add(1, std::memory_order_relaxed); // virtual loss until the backup
+            if (child.move != mcts::PASS) {
+                Bits flipped = BoardBits<N>::flips(child.move, own, opp);
+                own = own | flipped | bitboard::squareBit<Bits>(child.move);
+                opp = opp ^ flipped;
+            }
+            std::swap(own, opp);
+            path[len++] = index;
+        }
+
+        // The leaf's mover is the side not to move there; results alternate upwards.
+        int diff = playout(own, opp, rng);
+        uint32_t moverScore = diff < 0 ? 2 : diff == 0 ? 1 : 0;
+        for (int i = len - 1; i >= 0; i--) {
+            (*pool)[path[i]].score.fetch_add(moverScore, std::memory_order_relaxed);
+            moverScore = 2 - moverScore;
+        }
+
+        int depth = len - 1;
+        int seen = maxDepth.load(std::memory_order_relaxed);
+        while (depth > seen && !maxDepth.compare_exchange_weak(seen, depth, std::memory_order_relaxed)) {}
+    }
+
+    // The playout counter is kept current so reports can read it.
+    void work(uint64_t seed, bool reports, Clock::time_point start)
+    {
+        Xoshiro256 rng(seed);
+        uint32_t path[MAX_PATH + 1];
+        uint64_t done = 0;
+        auto nextReport = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(REPORT_INTERVAL));
+        while (!finished.load(std::memory_order_relaxed)) {
+            iterate(rng, path);
+            // The stop flag is cheap to read, the clock less so
+            if (++done % CHECK_EVERY != 0) {
+                if (external && external->load(std::memory_order_relaxed))
+                    finished.store(true, std::memory_order_relaxed);
+                continue;
+            }
+            playouts.fetch_add(CHECK_EVERY, std::memory_order_relaxed);
+            auto now = Clock::now();
+            if (now >= deadline)
+                finished.store(true, std::memory_order_relaxed);
+            else if (reports && now >= nextReport) {
+                reporter(snapshot(start));
+                nextReport = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(REPORT_INTERVAL));
+            }
+        }
+        playouts.fetch_add(done % CHECK_EVERY, std::memory_order_relaxed);
+    }
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "board.hpp"
+
+// Small quantized neural evaluation for the 8x8 board (NNUE style).
+//
+//   inputs  128  one plane of X discs and one of O discs, a bit per square
+//   L1      128  int16 accumulator = bias + sum of the weight columns of the
+//                set inputs, clipped to 0..127 and packed to uint8
+//   L2       32  int8 weights, int32 sums >> L2_SHIFT, clipped to 0..127
+//   output    1  int8 weights, divided by OUTPUT_SCALE
+//
+// The accumulator lives next to the board in the search and follows every
+// move: a placed disc adds its column, a flipped disc moves from one plane to
+// the other. Both are plain int16 adds, so undo subtracts the same columns and
+// the board is never scanned. Only the head (L1 -> L2 -> output) runs per
+// evaluation; it has scalar, SSE4.1 and AVX2 kernels picked at startup.
+
+namespace nnue {
+
+constexpr int INPUTS = 128;
+constexpr int L1 = 128;
+constexpr int L2 = 32;
+constexpr int L2_SHIFT = 6;
+constexpr int OUTPUT_SCALE = 16;
+
+inline int inputOf(int sq, Disk who) { return who == Disk::X ? sq : 64 + sq; }
+
+struct alignas(32) Accumulator {
+    int16_t v[L1];
+};
+
+} // namespace nnue
+
+class Network {
+public:
+    // Starts with a hand-built net that reproduces the square weights of
+    // eval.hpp, so `--eval nnue` works (and training has a start point)
+    // without a network file.
+    Network();
+
+    // Network file: "OTHNNUE1", uint32 L1, uint32 L2, then little-endian
+    // int16 b1[L1], int16 w1[INPUTS][L1], int32 b2[L2], int8 w2[L2][L1],
+    // int32 b3, int8 w3[L2]. Returns false and keeps the current weights when
+    // the file does not match.
+    bool load(const std::string& path, std::string* error = nullptr);
+    bool save(const std::string& path) const;
+
+    // Builds the accumulator of a position from scratch (once per root).
+    void init(nnue::Accumulator& acc, const Board<8>& b) const;
+
+    // Incremental updates: `who` played `sq` and turned the `flipped` discs.
+    void play(nnue::Accumulator& acc, int sq, Disk who, uint64_t flipped) const
+    {
+        add(acc, column(nnue::inputOf(sq, who)));
+        if (who == Disk::X)
+            while (flipped) add(acc, flipColumn(bitboard::popLowest(flipped)));
+        else
+            while (flipped) sub(acc, flipColumn(bitboard::popLowest(flipped)));
+    }
+
+    void undo(nnue::Accumulator& acc, int sq, Disk who, uint64_t flipped) const
+    {
+        sub(acc, column(nnue::inputOf(sq, who)));
+        if (who == Disk::X)
+            while (flipped) sub(acc, flipColumn(bitboard::popLowest(flipped)));
+        else
+            while (flipped) add(acc, flipColumn(bitboard::popLowest(flipped)));
+    }
+
+    // Score from the point of view of `side`.
+    int score(const nnue::Accumulator& acc, Disk side) const;
+
+    // Raw head output for X, in OUTPUT_SCALE units, through the current kernel.
+    int32_t forward(const nnue::Accumulator& acc) const;
+
+    const char* kernelName() const;
+
+    const int16_t* bias1() const { return b1.data(); }
+    const int32_t* bias2() const { return b2.data(); }
+    const int8_t* weights2() const { return w2.data(); }
+    int32_t bias3() const { return b3; }
+    const int8_t* weights3() const { return w3.data(); }
+
+private:
+    const int16_t* column(int input) const { return w1.data() + input * nnue::L1; }
+    // Column difference X - O of a square: what a flip to X adds.
+    const int16_t* flipColumn(int sq) const { return flip.data() + sq * nnue::L1; }
+
+    // int16 wraps around, so add followed by sub always restores the values.
+    static void add(nnue::Accumulator& acc, const int16_t* col)
+    {
+        for (int i = 0; i < nnue::L1; i++)
+            acc.v[i] = (int16_t)(acc.v[i] + col[i]);
+    }
+
+    static void sub(nnue::Accumulator& acc, const int16_t* col)
+    {
+        for (int i = 0; i < nnue::L1; i++)
+            acc.v[i] = (int16_t)(acc.v[i] - col[i]);
+    }
+
+    void rebuildFlipColumns();
+
+    std::vector<int16_t> b1;        // L1
+    std::vector<int16_t> w1;        // INPUTS x L1, column per input
+    std::vector<int16_t> flip;      // 64 x L1, derived from w1
+    std::vector<int32_t> b2;        // L2
+    std::vector<int8_t> w2;         // L2 x L1, row per output
+    int32_t b3 = 0;
+    std::vector<int8_t> w3;         // L2
+};
+
+namespace nnue {
+
+// Head kernels, picked at startup like the move generators in wide_bitboard.hpp.
+// OTHELLO_SIMD=scalar in the environment selects the scalar one.
+using HeadKernel = int32_t (*)(const Network& net, const Accumulator& acc);
+
+int32_t forwardScalar(const Network& net, const Accumulator& acc);
+#ifdef OTHELLO_HAVE_SSE41
+int32_t forwardSse4(const Network& net, const Accumulator& acc);
+#endif
+#ifdef OTHELLO_HAVE_AVX2
+int32_t forwardAvx2(const Network& net, const Accumulator& acc);
+#endif
+
+enum class Kernel { AUTO, SCALAR, SSE4, AVX2 };
+
+// Forces a kernel (for the benchmark); returns false when the CPU lacks it.
+bool useKernel(Kernel kernel);
+
+} // namespace nnue
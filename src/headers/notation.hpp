@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "board.hpp"
+
+// Moves written as squares run together, column letter then row number, as
+// in "f5d6c3" (upper case too; spaces between moves are skipped). Passes are
+// not written: they are implied by the position.
+
+// The squares (y * size + x) of `text`. False at the first thing that is not
+// a square of the board, which goes to `bad`.
+bool parseMoves(const std::string& text, int size, std::vector<uint8_t>& squares, std::string* bad = nullptr);
+
+// Plays `squares` on `board`, set up at the start of a game, passing where a
+// side has no move. `side` receives the side to move after
+// them (the other one when that side must pass). False at the first illegal
+// move, whose index goes to `illegal`; the board keeps the moves before it.
+bool playMoves(AnyBoard& board, const std::vector<uint8_t>& squares, Disk& side, size_t* illegal = nullptr);
+
+// Both in one, for the tools' command lines: false with "illegal move f9" or
+// the like in `error`.
+bool playMoves(AnyBoard& board, const std::string& text, Disk& side, std::string* error = nullptr);
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "board.hpp"
+
+class Engine;
+class GameDb;
+
+// Opening book: the move to play and its value for positions near the start
+// of the game, looked up before the engine searches.
+//
+// The file is a header and an array of entries sorted by the position's
+// symmetry-canonical key (symmetry.hpp), memory-mapped read-only: opening it
+// reads nothing but the header, whatever the size of the book, and processes
+// using the same book share it through the page cache. Keys are uniform, so
+// a lookup interpolates to the entry in a handful of probes.
+struct BookEntry {
+    uint64_t key;
+    int32_t score;      // for the side to move, on the search's scale
+    uint8_t move;       // square of the canonical image
+    uint8_t depth;      // search depth behind the score
+    uint16_t reserved;
+};
+
+struct BookMove {
+    int move = -1;      // square y * N + x of the probed board
+    int score = 0;
+    int depth = 0;
+};
+
+class OpeningBook {
+public:
+    OpeningBook() = default;
+    ~OpeningBook();
+
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    bool open(const std::string& path, std::string* error = nullptr);
+    bool isOpen() const { return base != nullptr; }
+    void close();
+
+    int boardSize() const { return size; }
+    size_t positions() const { return count; }
+    const BookEntry* data() const { return entries; }   // sorted by key
+
+    const BookEntry* find(uint64_t key) const;
+    // The book move of `side` here; false when the position is not in the
+    // book (or the book is for another board size).
+    bool probe(const AnyBoard& board, Disk side, BookMove& out) const;
+
+private:
+    const uint8_t* base = nullptr;
+    size_t length = 0;
+    const BookEntry* entries = nullptr;
+    size_t count = 0;
+    int size = 0;
+};
+
+// Book building by deviation search: from the starting position, every move
+// is searched to `depth`; the best one is followed, and so is every move that
+// loses at most `deviation` against it, as long as the losses along the line
+// add up to no more than `budget`. Lines stop after `plies` moves. The values
+// are then backed up through the book by negamax, so each position keeps the
+// move that is best against the book's own replies. With a database, moves
+// played in at least `minGames` of its games are followed too, however they
+// score.
+struct BookBuildOptions {
+    int boardSize = 8;
+    int plies = 12;
+    int depth = 10;
+    int deviation = 40;         // in evaluation units: a corner is 100 with
+    int budget = 80;            // the built-in square weights
+    const GameDb* db = nullptr;
+    uint32_t minGames = 100;
+    std::string base;           // a book to extend; its positions are not searched again
+};
+
+struct BookBuildStats {
+    uint64_t positions = 0;     // in the book
+    uint64_t searches = 0;
+    uint64_t reused = 0;        // positions taken from the base book
+    double seconds = 0;
+};
+
+bool buildBook(const BookBuildOptions& options, Engine& engine, const std::string& output,
+               BookBuildStats& stats, std::string* error = nullptr,
+               const std::function<void(const BookBuildStats&)>& progress = nullptr);
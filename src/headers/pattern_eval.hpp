@@ -0,0 +1,198 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "board.hpp"
+
+// Pattern-table evaluation for the 8x8 board.
+//
+// The board is cut into 34 pattern instances (edges, 3x3 corners, 2x5 corner
+// blocks and the diagonals of length 4 to 8). Each instance reads its squares
+// as a base-3 number (0 empty, 1 X, 2 O) that indexes a weight table shared by
+// every rotation / reflection of the same shape, with one table set per game
+// phase. The score is the sum of the looked-up weights, from X's point of view.
+//
+// The indices live in PatternFeatures and are updated from the placed and
+// flipped squares of each move, so evaluating never scans the grid.
+// Larger boards keep the square-weight evaluation in eval.hpp: pattern tables
+// grow as 3^length and there are no trained weights for them.
+
+namespace patterns {
+
+enum Shape { EDGE, CORNER3X3, CORNER2X5, DIAG8, DIAG7, DIAG6, DIAG5, DIAG4, SHAPES };
+
+constexpr int INSTANCES = 34;
+constexpr int SLOTS = 40;           // padded to a multiple of 8 for the AVX2 batch
+constexpr int PHASES = 8;           // by disc count: 4-11, 12-19, ..., 60-64
+constexpr int WEIGHT_SCALE = 16;    // weights are fixed point, score = sum / WEIGHT_SCALE
+
+inline int phaseOf(int discs) { return discs <= 4 ? 0 : std::min(PHASES - 1, (discs - 4) / 8); }
+
+// Squares of each shape in its canonical orientation, as y * 8 + x.
+struct ShapeDef {
+    int length;
+    int squares[10];
+};
+
+constexpr ShapeDef SHAPE_DEFS[SHAPES] = {
+    { 8, { 0, 1, 2, 3, 4, 5, 6, 7 } },                      // top edge
+    { 9, { 0, 1, 2, 8, 9, 10, 16, 17, 18 } },               // 3x3 corner
+    { 10, { 0, 1, 2, 3, 4, 8, 9, 10, 11, 12 } },            // 2x5 corner block
+    { 8, { 0, 9, 18, 27, 36, 45, 54, 63 } },                // main diagonal
+    { 7, { 8, 17, 26, 35, 44, 53, 62 } },                   // diagonals below it
+    { 6, { 16, 25, 34, 43, 52, 61 } },
+    { 5, { 24, 33, 42, 51, 60 } },
+    { 4, { 32, 41, 50, 59 } },
+};
+
+// Symmetries applied to each shape: bit 2 transposes, bits 0-1 rotate by 90 degrees.
+constexpr int SHAPE_SYMMETRIES[SHAPES] = { 4, 4, 8, 2, 4, 4, 4, 4 };
+
+constexpr int transform(int sq, int symmetry)
+{
+    int x = sq % 8, y = sq / 8;
+    if (symmetry & 4) {
+        int t = x; x = y; y = t;
+    }
+    for (int r = 0; r < (symmetry & 3); r++) {
+        int t = x; x = 7 - y; y = t;
+    }
+    return y * 8 + x;
+}
+
+constexpr int pow3(int n)
+{
+    int p = 1;
+    while (n-- > 0) p *= 3;
+    return p;
+}
+
+// For each square: the pattern instances that read it and its digit weight there.
+struct SquareRefs {
+    int count;
+    uint8_t instance[8];
+    uint16_t power[8];
+};
+
+struct Layout {
+    int shapeOf[INSTANCES];
+    int squareOf[INSTANCES][10];    // squares of each instance, in digit order
+    SquareRefs refs[64];
+};
+
+constexpr Layout makeLayout()
+{
+    Layout l{};
+    int inst = 0;
+    for (int s = 0; s < SHAPES; s++) {
+        for (int sym = 0; sym < SHAPE_SYMMETRIES[s]; sym++, inst++) {
+            l.shapeOf[inst] = s;
+            for (int i = 0; i < SHAPE_DEFS[s].length; i++) {
+                int sq = transform(SHAPE_DEFS[s].squares[i], sym);
+                l.squareOf[inst][i] = sq;
+                SquareRefs& r = l.refs[sq];
+                r.instance[r.count] = (uint8_t)inst;
+                r.power[r.count] = (uint16_t)pow3(i);
+                r.count++;
+            }
+        }
+    }
+    return l;
+}
+
+constexpr Layout LAYOUT = makeLayout();
+
+} // namespace patterns
+
+struct PatternFeatures {
+    uint16_t idx[patterns::SLOTS];  // slots past INSTANCES stay 0
+};
+
+class PatternEval {
+public:
+    // Starts with weights derived from the square weights in eval.hpp, so the
+    // evaluator is usable (and a tuning start point) without a weights file.
+    PatternEval();
+
+    // Weights file: "OTHPAT01", uint32 phases, uint32 entries per phase, then
+    // int16 little-endian weights, phase by phase. Returns false and leaves the
+    // current weights untouched when the file does not match.
+    bool load(const std::string& path, std::string* error = nullptr);
+    bool save(const std::string& path) const;
+
+    // Builds the indices of a position from scratch (once per root).
+    static void init(PatternFeatures& f, const Board<8>& b);
+
+    // Incremental updates: `who` played `sq` and turned the `flipped` discs.
+    // A new disc adds its digit (1 for X, 2 for O), a flip moves it by one.
+    static void play(PatternFeatures& f, int sq, Disk who, uint64_t flipped)
+    {
+        update(f, sq, who == Disk::X ? 1 : 2, flipped, who == Disk::X ? -1 : 1);
+    }
+
+    static void undo(PatternFeatures& f, int sq, Disk who, uint64_t flipped)
+    {
+        update(f, sq, who == Disk::X ? -1 : -2, flipped, who == Disk::X ? 1 : -1);
+    }
+
+    // Score from the point of view of `side`; `discs` is the number of discs on
+    // the board and selects the phase.
+    int score(const PatternFeatures& f, int discs, Disk side) const
+    {
+        const int16_t* w = weights.data() + patterns::phaseOf(discs) * stride;
+        int sum = 0;
+        for (int i = 0; i < patterns::INSTANCES; i++)
+            sum += w[offsets[i] + f.idx[i]];
+        sum /= patterns::WEIGHT_SCALE;
+        return side == Disk::X ? sum : -sum;
+    }
+
+    // Scores n positions at once (X's point of view, in weight units: divide by
+    // WEIGHT_SCALE). Uses AVX2 gathers when the CPU has them.
+    void scoreBatch(const PatternFeatures* f, const uint8_t* phase, int n, int32_t* out) const;
+
+    const char* batchKernelName() const;
+
+    // Offsets of every slot inside one phase of the weight table; the padding
+    // slots point at a zero entry at the end.
+    const std::array<int32_t, patterns::SLOTS>& slotOffsets() const { return offsets; }
+    const int16_t* weightData() const { return weights.data(); }
+    int phaseStride() const { return stride; }
+
+private:
+    static void update(PatternFeatures& f, int sq, int placed, uint64_t flipped, int flip)
+    {
+        const patterns::SquareRefs& r = patterns::LAYOUT.refs[sq];
+        for (int i = 0; i < r.count; i++)
+            f.idx[r.instance[i]] += placed * r.power[i];
+        while (flipped) {
+            const patterns::SquareRefs& fr = patterns::LAYOUT.refs[bitboard::popLowest(flipped)];
+            for (int i = 0; i < fr.count; i++)
+                f.idx[fr.instance[i]] += flip * fr.power[i];
+        }
+    }
+
+    std::vector<int16_t> weights;   // PHASES * stride, plus padding for 32-bit gathers
+    std::array<int32_t, patterns::SLOTS> offsets;
+    int stride;
+};
+
+namespace patterns {
+
+// Batch kernels, picked at startup like the move generators in wide_bitboard.hpp.
+// OTHELLO_SIMD=scalar in the environment selects the scalar one.
+using BatchKernel = void (*)(const PatternEval& eval, const PatternFeatures* f, const uint8_t* phase,
+                             int n, int32_t* out);
+
+void scoreBatchScalar(const PatternEval& eval, const PatternFeatures* f, const uint8_t* phase, int n, int32_t* out);
+#ifdef OTHELLO_HAVE_AVX2
+void scoreBatchAvx2(const PatternEval& eval, const PatternFeatures* f, const uint8_t* phase, int n, int32_t* out);
+#endif
+
+void useScalarBatch(bool scalar);
+
+} // namespace patterns
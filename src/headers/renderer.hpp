@@ -5,22 +5,76 @@
 
 #include "board.hpp"
 #include "color.hpp"
+#include "frame.hpp"
+#include "game_db.hpp"
+#include "layout.hpp"
 #include "utils.hpp"
 
 struct MoveRecord {
     int row;
     int col;
-    Board::Disk player;
+    Disk player;
 };
 
+// The draw calls build a frame in memory, starting with beginFrame();
+// present() then sends the terminal only what changed since the last frame.
+// Where things go comes from a Layout kept for the terminal's size, which is
+// read once here and again only through resize().
 class Renderer {
 public:
-    void drawBoard(const Board & b, const std::vector<std::pair<int,int>> & valid, Board::Disk turn,
-                   int cursorX, int cursorY) const;
+    // Parts of the screen that are drawn separately. STATIC is what never
+    // changes during a game: the title and the instructions.
+    enum Region : unsigned {
+        BOARD = 1, SCORE = 2, CLOCK = 4, HISTORY = 8, STATUS = 16, STATIC = 32,
+        ALL = 63
+    };
+
+    Renderer() { resize(); }
+
+    // Starts a frame that redraws `regions`: the rest is kept from the last
+    // frame. Returns the regions to draw, which is ALL when the last frame
+    // cannot be reused (first frame, resize).
+    unsigned beginFrame(int boardSize, unsigned regions = ALL);
+    void drawBoard(const AnyBoard & b, const std::vector<std::pair<int,int>> & valid, Disk turn,
+                   int cursorX, int cursorY);
     void drawSideMenu(const std::vector<MoveRecord>& history, int scoreX, int scoreO, 
-                      Board::Disk currentTurn, int cursorX, int cursorY, int elapsedSeconds, int boardSize) const;
-    void drawInstructions(int x, int y) const;
-    void drawMoveHistory(const std::vector<MoveRecord>& history, int x, int y, int scrollOffset = 0) const;
+                      Disk currentTurn, int cursorX, int cursorY, int elapsedSeconds, int boardSize,
+                      const std::string& status = "", unsigned regions = ALL);
+    void drawInstructions(int x, int y);
+    void drawMoveHistory(const std::vector<MoveRecord>& history, int x, int y, int scrollOffset = 0);
+    // Database statistics of the legal moves, beside the history (HISTORY
+    // region); nothing when the layout has no room for them.
+    void drawDatabase(const std::vector<MoveStats>& moves);
+    void drawText(int x, int y, const std::string& text, TextColor color);
+    void present();
+    // The screen was drawn on directly (menus): the next frame is sent whole.
+    void invalidate() { repaint = true; }
+    // The terminal changed size (SIGWINCH): re-read it, lay the screen out
+    // again and send the next frame whole.
+    void resize();
+    const Layout& layout() const { return lay; }
+
+    // Output volume of present(), for --frame-stats.
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t bytes = 0;
+        size_t lastBytes = 0;
+        size_t maxBytes = 0;
+    };
+    const Stats& frameStats() const { return stats; }
+
+private:
+    void drawCompactBoard(const AnyBoard& b, const std::vector<std::pair<int,int>>& valid,
+                          int cursorX, int cursorY);
+    void updateLayout(int boardSize);
+
+    int termCols = 0, termRows = 0;
+    Layout lay;
+    Frame back;     // frame being drawn
+    Frame front;    // what the terminal shows
+    FrameOutput output;
+    bool repaint = true;
+    Stats stats;
 };
 
 
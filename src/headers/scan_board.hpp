@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include "board.hpp"
+
+// Mailbox board with the original 8-direction scanner (scan / scanAndFlip).
+// It is the reference the bitboard backends are checked against (perft --verify),
+// so it deliberately stays simple. Same interface as Board<N>.
+template <int N>
+class ScanBoard {
+public:
+    static constexpr int SIZE = N;
+    static constexpr int CELLS = N * N;
+
+private:
+    static constexpr int DX[8] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+    static constexpr int DY[8] = { 1, 0, -1, 0, 1, -1, 1, -1 };
+
+    // Number of cells between each square and the board edge, per direction.
+    struct Rays {
+        unsigned char len[N * N][8];
+    };
+
+    static constexpr Rays makeRays()
+    {
+        Rays r{};
+        for (int sq = 0; sq < N * N; sq++) {
+            for (int d = 0; d < 8; d++) {
+                int x = sq % N + DX[d], y = sq / N + DY[d], n = 0;
+                for (; x >= 0 && x < N && y >= 0 && y < N; x += DX[d], y += DY[d]) n++;
+                r.len[sq][d] = (unsigned char)n;
+            }
+        }
+        return r;
+    }
+
+    static constexpr Rays RAYS = makeRays();
+
+    std::array<Disk, N * N> grid;
+
+    bool scan(int sq, int d, Disk current) const
+    {
+        int step = DY[d] * N + DX[d];
+        bool anyOther = false;
+
+        for (int i = 0, p = sq + step; i < RAYS.len[sq][d]; i++, p += step) {
+            if (grid[p] == Disk::Empty)
+                return false;
+            if (grid[p] == current)
+                return anyOther;
+            anyOther = true;
+        }
+        return false;
+    }
+
+    void scanAndFlip(int sq, int d)
+    {
+        if (!scan(sq, d, grid[sq]))
+            return;
+        int step = DY[d] * N + DX[d];
+        for (int p = sq + step; grid[p] != grid[sq]; p += step)
+            grid[p] = grid[sq];
+    }
+
+public:
+    explicit ScanBoard(bool initial = true)
+    {
+        grid.fill(Disk::Empty);
+        if (initial)
+            reset();
+    }
+
+    void reset()
+    {
+        constexpr int c = N / 2;
+        grid.fill(Disk::Empty);
+        grid[(c-1) * N + c-1] = Disk::O;
+        grid[(c-1) * N + c] = Disk::X;
+        grid[c * N + c-1] = Disk::X;
+        grid[c * N + c] = Disk::O;
+    }
+
+    static constexpr int getSize() { return N; }
+
+    bool isValid(int x, int y, Disk current) const
+    {
+        int sq = y * N + x;
+        if (grid[sq] != Disk::Empty)
+            return false;
+        for (int d = 0; d < 8; d++)
+            if (scan(sq, d, current))
+                return true;
+        return false;
+    }
+
+    std::vector<std::pair<int, int>> getValid(Disk current) const
+    {
+        std::vector<std::pair<int, int>> out;
+        for (int y = 0; y < N; y++)
+            for (int x = 0; x < N; x++)
+                if (isValid(x, y, current))
+                    out.emplace_back(x, y);
+        return out;
+    }
+
+    void put(int x, int y, Disk current)
+    {
+        int sq = y * N + x;
+        assert(grid[sq] == Disk::Empty);
+        grid[sq] = current;
+        for (int d = 0; d < 8; d++)
+            scanAndFlip(sq, d);
+    }
+
+    Disk get(int x, int y) const { return grid[y * N + x]; }
+    void set(int x, int y, Disk d) { grid[y * N + x] = d; }
+
+    int count(Disk who) const
+    {
+        int c = 0;
+        for (Disk d : grid)
+            if (d == who)
+                c++;
+        return c;
+    }
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "board.hpp"
+#include "engine.hpp"
+#include "game_record.hpp"
+#include "xoshiro.hpp"
+
+// Headless games between computer players, for self-play data and engine
+// matches: no terminal, no Renderer, no event loop. A Player keeps its engine
+// (and transposition table) from one game to the next, so a worker thread
+// that owns its players, board and record allocates nothing per game.
+struct PlayerConfig {
+    bool random = false;        // uniformly random legal moves
+    SearchLimits limits;        // per move: depth, time, exact solve
+    EvalKind eval = EvalKind::SQUARES;
+    Algorithm algorithm = Algorithm::ALPHA_BETA;
+    int threads = 1;
+    size_t hashMB = 16;
+};
+
+class Player {
+public:
+    explicit Player(const PlayerConfig& config);
+
+    const PlayerConfig& config() const { return settings; }
+    void newGame();
+    // A legal move of `side` (which has one) as the square y * N + x. The
+    // engine's search is limited by `limits`, or by the configuration's.
+    int chooseMove(const AnyBoard& board, Disk side, Xoshiro256& rng, const SearchLimits* limits = nullptr);
+    const SearchResult& lastSearch() const { return last; }
+
+private:
+    PlayerConfig settings;
+    std::unique_ptr<Engine> engine;     // none for the random player
+    SearchResult last;
+};
+
+// A game clock: `base` seconds for each side plus `increment` per move.
+// Each engine move is given a share of what is left on its clock.
+struct TimeControl {
+    double base = 0;
+    double increment = 0;
+};
+
+// Plays a game from `opening` (squares, passes implied) and then `randomPlies`
+// random moves, to the end. `board` is reset first; `game` receives the moves
+// (with passes), the time each side took and the final discs. With a clock,
+// the game stops when a side oversteps it: that side is returned (otherwise
+// Disk::Empty).
+Disk playGame(AnyBoard& board, Player& x, Player& o, const std::vector<uint8_t>& opening,
+              int randomPlies, Xoshiro256& rng, GameRecord& game, const TimeControl* clock = nullptr);
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+
+#include "board.hpp"
+#include "zobrist.hpp"
+
+// The 8 symmetries of a square board and position keys that are the same for
+// all 8 images of a position, so that the game database and the opening book
+// store each position once whichever way round it was reached.
+namespace symmetry {
+
+constexpr int COUNT = 8;
+
+// Square sq of an N x N board under symmetry s: bit 2 transposes, bits 0-1
+// rotate by 90 degrees (as pattern_eval's transform, for any size).
+template <int N>
+constexpr int transform(int sq, int s)
+{
+    int x = sq % N, y = sq / N;
+    if (s & 4) {
+        int t = x; x = y; y = t;
+    }
+    for (int r = 0; r < (s & 3); r++) {
+        int t = x; x = N - 1 - y; y = t;
+    }
+    return y * N + x;
+}
+
+// The symmetry that undoes s.
+constexpr int inverse(int s)
+{
+    // Rotations undo each other; a transpose followed by a rotation is a
+    // reflection, which is its own inverse
+    return s & 4 ? s : (4 - s) & 3;
+}
+
+// Zobrist keys seen through each symmetry: the key of a position's image
+// under s is the xor of disc[s][colour][square] over its discs.
+template <int N>
+struct Keys {
+    uint64_t disc[COUNT][2][N * N];
+};
+
+template <int N>
+constexpr Keys<N> makeKeys()
+{
+    Keys<N> k{};
+    for (int s = 0; s < COUNT; s++)
+        for (int c = 0; c < 2; c++)
+            for (int sq = 0; sq < N * N; sq++)
+                k.disc[s][c][sq] = ZOBRIST<N>.disc[c][transform<N>(sq, s)];
+    return k;
+}
+
+template <int N>
+inline constexpr Keys<N> KEYS = makeKeys<N>();
+
+// The smallest of the Zobrist keys of b's 8 images, with `side` xor'ed in as
+// in Board::hash(side); never 0. `image`, when given, receives the symmetry
+// that gives that image: square sq of b is transform<N>(sq, *image) there.
+template <int N>
+uint64_t canonicalKey(const Board<N>& b, Disk side, int* image = nullptr)
+{
+    using Bits = typename Board<N>::Bits;
+    uint64_t keys[COUNT] = {};
+    for (int c = 0; c < 2; c++) {
+        for (Bits d = b.discs(c == 0 ? Disk::X : Disk::O); bitboard::any(d); ) {
+            int sq = bitboard::popLowest(d);
+            for (int s = 0; s < COUNT; s++)
+                keys[s] ^= KEYS<N>.disc[s][c][sq];
+        }
+    }
+    int best = 0;
+    for (int s = 1; s < COUNT; s++)
+        if (keys[s] < keys[best])
+            best = s;
+    if (image)
+        *image = best;
+    uint64_t key = side == Disk::O ? keys[best] ^ ZOBRIST<N>.side : keys[best];
+    return key ? key : 1;
+}
+
+} // namespace symmetry
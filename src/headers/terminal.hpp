@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <csignal>
+#include <vector>
+
+#include <termios.h>
+
+#include "cursor_input.hpp"
+
+// Keeps the terminal in non-canonical, no-echo mode for its lifetime: set
+// once for the whole game rather than around every read, and restored on the
+// way out (including when the game loop throws, or SIGINT, SIGTERM or SIGHUP
+// ends the process).
+class TerminalSession {
+public:
+    TerminalSession();
+    ~TerminalSession();
+
+    TerminalSession(const TerminalSession&) = delete;
+    TerminalSession& operator=(const TerminalSession&) = delete;
+
+private:
+    termios saved;
+    bool active = false;
+    struct sigaction previous[3];   // SIGINT, SIGTERM, SIGHUP handlers before ours
+};
+
+// What the game loop waits for: keys on stdin, the once-a-second tick of the
+// clock on the side menu (a timerfd), responses from the engine thread (an
+// eventfd it signals) and terminal resizes (SIGWINCH, through a self-pipe so
+// the handler does nothing but write a byte). wait() blocks in poll() until one of them is ready, so
+// an idle game uses no CPU and a key is handled as soon as it arrives.
+class EventLoop {
+public:
+    enum : unsigned { KEYS = 1, TICK = 2, ENGINE = 4, RESIZE = 8 };
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // Ticks on every whole second after `origin` (the game's start time).
+    void startClock(std::chrono::steady_clock::time_point origin);
+    void watchEngine(int fd) { engineFd = fd; }
+
+    // Blocks until at least one event; returns them as a mask, with the keys
+    // read appended to `keys`. timeoutMs < 0 waits for as long as it takes;
+    // on timeout the mask is 0.
+    unsigned wait(std::vector<Key>& keys, int timeoutMs = -1);
+
+    // Blocks until a key (and only that), for the menus. A resize meanwhile is
+    // kept for the next wait().
+    Key waitKey();
+
+private:
+    KeyDecoder decoder;
+    int timerFd = -1;
+    int engineFd = -1;
+    int resizeFd = -1;          // read end of the SIGWINCH self-pipe
+    unsigned deferred = 0;      // events seen by waitKey(), not yet returned
+    std::vector<Key> queued;    // decoded by an earlier read, not yet returned
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Transposition table shared by every search thread.
+//
+// Buckets are one cache line (4 entries of 16 bytes). Entries are lockless:
+// each stores `key ^ data` next to `data`, so a reader that races with a writer
+// sees a key mismatch and treats the entry as a miss instead of using torn data.
+class TranspositionTable {
+public:
+    enum Bound : uint8_t { NONE = 0, UPPER = 1, LOWER = 2, EXACT = 3 };
+
+    struct Hit {
+        int score;
+        int depth;
+        int move;       // square index, -1 when unknown
+        Bound bound;
+    };
+
+    explicit TranspositionTable(size_t megabytes = 64);
+
+    // Reallocates (and clears) the table; the size is rounded down to a power of two.
+    void resize(size_t megabytes);
+    void clear();
+    size_t sizeMB() const { return (bucketCount * sizeof(Bucket)) >> 20; }
+
+    // Call once per root search so entries from older searches get replaced first.
+    void newSearch() { generation = (generation + 1) & GEN_MASK; }
+
+    bool probe(uint64_t key, Hit& out) const;
+    void store(uint64_t key, int score, int depth, int move, Bound bound);
+
+    // Permille of sampled entries written by the current search.
+    int hashfull() const;
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> check;    // key ^ data
+        std::atomic<uint64_t> data;
+    };
+
+    struct alignas(64) Bucket {
+        Entry entries[4];
+    };
+
+    static constexpr uint8_t GEN_MASK = 0x3F;
+
+    std::unique_ptr<Bucket[]> buckets;
+    size_t bucketCount = 0;
+    uint8_t generation = 0;
+
+    // data layout: score (32) | depth (8) | move (8) | bound (2) | generation (6)
+    static uint64_t pack(int score, int depth, int move, Bound bound, uint8_t gen)
+    {
+        return (uint64_t)(uint32_t)score | (uint64_t)(uint8_t)depth << 32 |
+               (uint64_t)(uint8_t)(move < 0 ? 0xFF : move) << 40 |
+               (uint64_t)bound << 48 | (uint64_t)(gen & GEN_MASK) << 50;
+    }
+
+    Bucket& bucketFor(uint64_t key) const { return buckets[key & (bucketCount - 1)]; }
+};
@@ -10,11 +10,7 @@ void clearTerminal(); // Full terminal reset
 void hideCursor();
 void showCursor();
 
-int getch();    // For key input
-bool kbhit();   // For non-blocking keyboard input
-
 void terminal_size(int width, int height);
-void sleep_ms(int ms);
 int random_range(int min, int max);
 std::string formatTime(int totalSeconds);
 
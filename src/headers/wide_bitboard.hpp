@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "bitboard.hpp"
+
+// Multi-word bitboards for the board sizes that do not fit in 64 bits.
+// Square index is y * N + x, packed little-endian across the words: bit i lives
+// in w[i / 64]. Bits past N * N are always zero.
+struct alignas(16) Bits128 {
+    uint64_t w[2];
+};
+
+struct alignas(32) Bits256 {
+    uint64_t w[4];
+};
+
+namespace widebits {
+
+template <class B> constexpr int WORDS = sizeof(B) / sizeof(uint64_t);
+
+template <class B> struct IsWide { static constexpr bool value = false; };
+template <> struct IsWide<Bits128> { static constexpr bool value = true; };
+template <> struct IsWide<Bits256> { static constexpr bool value = true; };
+
+} // namespace widebits
+
+template <class B, class = std::enable_if_t<widebits::IsWide<B>::value>>
+inline B operator|(const B& a, const B& b)
+{
+    B r;
+    for (int i = 0; i < widebits::WORDS<B>; i++) r.w[i] = a.w[i] | b.w[i];
+    return r;
+}
+
+template <class B, class = std::enable_if_t<widebits::IsWide<B>::value>>
+inline B operator&(const B& a, const B& b)
+{
+    B r;
+    for (int i = 0; i < widebits::WORDS<B>; i++) r.w[i] = a.w[i] & b.w[i];
+    return r;
+}
+
+template <class B, class = std::enable_if_t<widebits::IsWide<B>::value>>
+inline B operator^(const B& a, const B& b)
+{
+    B r;
+    for (int i = 0; i < widebits::WORDS<B>; i++) r.w[i] = a.w[i] ^ b.w[i];
+    return r;
+}
+
+// Note: ~ sets the padding bits above N * N too; mask the result before storing it.
+template <class B, class = std::enable_if_t<widebits::IsWide<B>::value>>
+inline B operator~(const B& a)
+{
+    B r;
+    for (int i = 0; i < widebits::WORDS<B>; i++) r.w[i] = ~a.w[i];
+    return r;
+}
+
+namespace bitboard {
+
+template <> inline Bits128 squareBit<Bits128>(int sq)
+{
+    Bits128 b{};
+    b.w[sq >> 6] = 1ULL << (sq & 63);
+    return b;
+}
+
+template <> inline Bits256 squareBit<Bits256>(int sq)
+{
+    Bits256 b{};
+    b.w[sq >> 6] = 1ULL << (sq & 63);
+    return b;
+}
+
+template <class B, class = std::enable_if_t<widebits::IsWide<B>::value>>
+inline bool test(const B& b, int sq) { return (b.w[sq >> 6] >> (sq & 63)) & 1; }
+
+template <class B, class = std::enable_if_t<widebits::IsWide<B>::value>>
+inline bool any(const B& b)
+{
+    uint64_t acc = 0;
+    for (int i = 0; i < widebits::WORDS<B>; i++) acc |= b.w[i];
+    return acc != 0;
+}
+
+template <class B, class = std::enable_if_t<widebits::IsWide<B>::value>>
+inline int popcount(const B& b)
+{
+    int c = 0;
+    for (int i = 0; i < widebits::WORDS<B>; i++) c += __builtin_popcountll(b.w[i]);
+    return c;
+}
+
+template <class B, class = std::enable_if_t<widebits::IsWide<B>::value>>
+inline int popLowest(B& b)
+{
+    int i = 0;
+    while (!b.w[i]) i++;
+    int sq = i * 64 + __builtin_ctzll(b.w[i]);
+    b.w[i] &= b.w[i] - 1;
+    return sq;
+}
+
+} // namespace bitboard
+
+namespace widebits {
+
+// Move generator kernels for one board size. The implementation (scalar, SSE2
+// or AVX2) is picked once at startup from what the CPU supports.
+template <class B>
+struct Kernels {
+    B (*moves)(const B& own, const B& opp);
+    B (*flips)(int sq, const B& own, const B& opp);
+    const char* name;
+};
+
+extern Kernels<Bits128> kernels10;
+extern Kernels<Bits256> kernels12;
+
+// Force the portable scalar kernels (true) or go back to the best available (false).
+void useScalarKernels(bool scalar);
+
+// Per-ISA entry points, defined in wide_bitboard_*.cpp. Those translation units are
+// built with different -m flags, so they only use their own kernel code and never
+// instantiate the inline helpers above.
+Bits128 moves10Scalar(const Bits128& own, const Bits128& opp);
+Bits128 flips10Scalar(int sq, const Bits128& own, const Bits128& opp);
+Bits256 moves12Scalar(const Bits256& own, const Bits256& opp);
+Bits256 flips12Scalar(int sq, const Bits256& own, const Bits256& opp);
+
+#ifdef OTHELLO_HAVE_SSE2
+Bits128 moves10Sse2(const Bits128& own, const Bits128& opp);
+Bits128 flips10Sse2(int sq, const Bits128& own, const Bits128& opp);
+#endif
+
+#ifdef OTHELLO_HAVE_AVX2
+Bits256 moves12Avx2(const Bits256& own, const Bits256& opp);
+Bits256 flips12Avx2(int sq, const Bits256& own, const Bits256& opp);
+#endif
+
+} // namespace widebits
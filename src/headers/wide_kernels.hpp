@@ -0,0 +1,165 @@
+#pragma once
+
+// Generic Kogge-Stone move generator shared by the wide_bitboard_*.cpp files.
+// Each of those files is compiled with different -m flags and plugs in its own
+// vector "Ops" (load/store, and/or/andnot, whole-register shifts), so everything
+// here sits in an unnamed namespace: every translation unit gets a private copy
+// and no ISA-specific code can leak into another one through the linker.
+
+#include <cstdint>
+
+namespace {
+
+template <int W>
+struct WideMasks {
+    uint64_t inner[W]; // columns 1 .. N-2, blocks horizontal/diagonal wrap-around
+    uint64_t full[W];  // the N * N squares of the board
+};
+
+template <int N, int W>
+constexpr WideMasks<W> makeWideMasks()
+{
+    WideMasks<W> m{};
+    for (int sq = 0; sq < N * N; sq++) {
+        int x = sq % N;
+        m.full[sq / 64] |= 1ULL << (sq % 64);
+        if (x != 0 && x != N - 1)
+            m.inner[sq / 64] |= 1ULL << (sq % 64);
+    }
+    return m;
+}
+
+// Plain uint64_t lanes, used when no vector unit is available (or forced).
+template <int W>
+struct ScalarOps {
+    static constexpr int WORDS = W;
+    struct V { uint64_t w[W]; };
+
+    static V load(const uint64_t* p) { V v; for (int i = 0; i < W; i++) v.w[i] = p[i]; return v; }
+    static void store(uint64_t* p, V v) { for (int i = 0; i < W; i++) p[i] = v.w[i]; }
+    static V and_(V a, V b) { for (int i = 0; i < W; i++) a.w[i] &= b.w[i]; return a; }
+    static V or_(V a, V b) { for (int i = 0; i < W; i++) a.w[i] |= b.w[i]; return a; }
+    static V andnot(V a, V b) { for (int i = 0; i < W; i++) a.w[i] = ~a.w[i] & b.w[i]; return a; }
+    static bool testz(V a) { uint64_t acc = 0; for (int i = 0; i < W; i++) acc |= a.w[i]; return acc == 0; }
+
+    template <int K>
+    static V shl(V a)
+    {
+        constexpr int q = K / 64, r = K % 64;
+        V out;
+        for (int i = W - 1; i >= 0; i--) {
+            uint64_t hi = i - q >= 0 ? a.w[i - q] << r : 0;
+            uint64_t lo = (r && i - q - 1 >= 0) ? a.w[i - q - 1] >> ((64 - r) & 63) : 0;
+            out.w[i] = hi | lo;
+        }
+        return out;
+    }
+
+    template <int K>
+    static V shr(V a)
+    {
+        constexpr int q = K / 64, r = K % 64;
+        V out;
+        for (int i = 0; i < W; i++) {
+            uint64_t lo = i + q < W ? a.w[i + q] >> r : 0;
+            uint64_t hi = (r && i + q + 1 < W) ? a.w[i + q + 1] << ((64 - r) & 63) : 0;
+            out.w[i] = hi | lo;
+        }
+        return out;
+    }
+};
+
+template <class Ops, int N>
+struct WideKernel {
+    using V = typename Ops::V;
+    static constexpr int W = Ops::WORDS;
+    static constexpr WideMasks<W> masks = makeWideMasks<N, W>();
+
+    // Doubling steps needed to cover the longest opponent run (N - 2 discs).
+    static constexpr int STEPS = N - 2 > 8 ? 4 : 3;
+
+    template <int S>
+    static V sh(V v)
+    {
+        if constexpr (S > 0)
+            return Ops::template shl<S>(v);
+        else
+            return Ops::template shr<-S>(v);
+    }
+
+    template <int S>
+    static V fill(V gen, V pro)
+    {
+        gen = Ops::or_(gen, Ops::and_(pro, sh<S>(gen)));
+        pro = Ops::and_(pro, sh<S>(pro));
+        gen = Ops::or_(gen, Ops::and_(pro, sh<2 * S>(gen)));
+        pro = Ops::and_(pro, sh<2 * S>(pro));
+        gen = Ops::or_(gen, Ops::and_(pro, sh<4 * S>(gen)));
+        if constexpr (STEPS > 3) {
+            pro = Ops::and_(pro, sh<4 * S>(pro));
+            gen = Ops::or_(gen, Ops::and_(pro, sh<8 * S>(gen)));
+        }
+        return gen;
+    }
+
+    template <int S>
+    static V movesDir(V own, V pro, V empty)
+    {
+        return Ops::and_(sh<S>(fill<S>(Ops::and_(sh<S>(own), pro), pro)), empty);
+    }
+
+    template <int S>
+    static void flipsDir(V from, V own, V pro, V& acc)
+    {
+        V run = fill<S>(Ops::and_(sh<S>(from), pro), pro);
+        if (!Ops::testz(Ops::and_(sh<S>(run), own)))
+            acc = Ops::or_(acc, run);
+    }
+
+    template <class B>
+    static B moves(const B& ownB, const B& oppB)
+    {
+        V own = Ops::load(ownB.w);
+        V opp = Ops::load(oppB.w);
+        V inner = Ops::and_(opp, Ops::load(masks.inner));
+        V empty = Ops::andnot(Ops::or_(own, opp), Ops::load(masks.full));
+
+        V r = Ops::or_(movesDir<N>(own, opp, empty), movesDir<-N>(own, opp, empty));
+        r = Ops::or_(r, Ops::or_(movesDir<1>(own, inner, empty), movesDir<-1>(own, inner, empty)));
+        r = Ops::or_(r, Ops::or_(movesDir<N + 1>(own, inner, empty), movesDir<-(N + 1)>(own, inner, empty)));
+        r = Ops::or_(r, Ops::or_(movesDir<N - 1>(own, inner, empty), movesDir<-(N - 1)>(own, inner, empty)));
+
+        B out;
+        Ops::store(out.w, r);
+        return out;
+    }
+
+    template <class B>
+    static B flips(int sq, const B& ownB, const B& oppB)
+    {
+        uint64_t fromBits[W] = {};
+        uint64_t zeroBits[W] = {};
+        fromBits[sq / 64] = 1ULL << (sq % 64);
+
+        V from = Ops::load(fromBits);
+        V own = Ops::load(ownB.w);
+        V opp = Ops::load(oppB.w);
+        V inner = Ops::and_(opp, Ops::load(masks.inner));
+        V acc = Ops::load(zeroBits);
+
+        flipsDir<N>(from, own, opp, acc);
+        flipsDir<-N>(from, own, opp, acc);
+        flipsDir<1>(from, own, inner, acc);
+        flipsDir<-1>(from, own, inner, acc);
+        flipsDir<N + 1>(from, own, inner, acc);
+        flipsDir<-(N + 1)>(from, own, inner, acc);
+        flipsDir<N - 1>(from, own, inner, acc);
+        flipsDir<-(N - 1)>(from, own, inner, acc);
+
+        B out;
+        Ops::store(out.w, acc);
+        return out;
+    }
+};
+
+} // namespace
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+// Zobrist keys for one board size, generated at compile time with splitmix64.
+// Every size gets its own stream, so positions of different sizes never share keys.
+template <int N>
+struct Zobrist {
+    uint64_t disc[2][N * N];   // [0] = X, [1] = O
+    uint64_t flip[N * N];      // disc[0][sq] ^ disc[1][sq]: a disc changing colour
+    uint64_t side;             // xor'ed in when O is to move
+};
+
+constexpr uint64_t splitmix64(uint64_t& state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+template <int N>
+constexpr Zobrist<N> makeZobrist()
+{
+    Zobrist<N> z{};
+    uint64_t state = 0x0DD0'7E11'0000'0000ULL + N;
+    for (int c = 0; c < 2; c++)
+        for (int sq = 0; sq < N * N; sq++)
+            z.disc[c][sq] = splitmix64(state);
+    for (int sq = 0; sq < N * N; sq++)
+        z.flip[sq] = z.disc[0][sq] ^ z.disc[1][sq];
+    z.side = splitmix64(state);
+    return z;
+}
+
+template <int N>
+inline constexpr Zobrist<N> ZOBRIST = makeZobrist<N>();
@@ -0,0 +1,77 @@
+#include "layout.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+constexpr int TITLE_BOARD_TOP = 10;     // below the title and the column labels
+constexpr int PLAIN_BOARD_TOP = 3;
+constexpr int PANEL_GAP = 4;
+constexpr int DATABASE_GAP = 2;
+constexpr int MAX_HISTORY = 10;
+constexpr int MIN_HISTORY = 3;
+
+// Panel rows other than the listed moves: score box, turn, cursor, status,
+// history caption and box borders, instructions box.
+constexpr int PANEL_FIXED_ROWS = 16;
+
+Layout place(int cols, int rows, int n, bool title, bool compact, bool below)
+{
+    Layout l;
+    l.cols = cols;
+    l.rows = rows;
+    l.boardSize = n;
+    l.title = title;
+    l.compact = compact;
+    l.boardTop = title ? TITLE_BOARD_TOP : PLAIN_BOARD_TOP;
+    l.boardWidth = compact ? 2 * n + 3 : 4 * n + 1;
+    l.boardHeight = compact ? n + 2 : 2 * n + 1;
+    l.messageX = l.boardLeft;
+    l.messageY = l.boardTop + l.boardHeight;
+    if (below) {
+        l.menuX = l.boardLeft;
+        l.menuY = l.messageY + 2;
+    } else {
+        l.menuX = l.boardLeft + l.boardWidth + PANEL_GAP;
+        l.menuY = l.boardTop;
+    }
+    l.historyRows = clamp(rows - l.menuY + 1 - PANEL_FIXED_ROWS, MIN_HISTORY - 1, MAX_HISTORY);
+    l.instructionsY = l.menuY + 10 + l.historyRows;
+    l.databaseX = l.menuX + Layout::PANEL_WIDTH + DATABASE_GAP;
+    l.database = l.databaseX + Layout::DATABASE_WIDTH - 1 <= cols;
+    return l;
+}
+
+bool fits(const Layout& l)
+{
+    return l.historyRows >= MIN_HISTORY &&
+           l.menuX + Layout::PANEL_WIDTH - 1 <= l.cols &&
+           l.boardLeft + l.boardWidth - 1 <= l.cols &&
+           l.messageY + 1 <= l.rows;
+}
+
+} // namespace
+
+Layout Layout::compute(int cols, int rows, int boardSize)
+{
+    struct Option { bool title, compact, below; };
+    static const Option options[] = {
+        { true, false, false },
+        { false, false, false },
+        { true, true, false },
+        { false, true, false },
+        { false, false, true },
+        { false, true, true },
+    };
+    for (const Option& o : options) {
+        Layout l = place(cols, rows, boardSize, o.title, o.compact, o.below);
+        if (fits(l))
+            return l;
+    }
+    Layout l = place(cols, rows, boardSize, false, true, false);
+    l.historyRows = MIN_HISTORY;
+    l.instructionsY = l.menuY + 10 + l.historyRows;
+    return l;
+}
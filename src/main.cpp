@@ -1,8 +1,175 @@
+#include "bench.hpp"
 #include "game.hpp"
+#include "nnue.hpp"
+#include "pattern_eval.hpp"
 
-int main()
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+static void usage()
+{
+    cerr << "usage: Othello [--hash MB] [--threads N] [--exact EMPTIES] [--engine alphabeta|mcts]\n"
+            "               [--tree MB] [--eval square|pattern|nnue] [--weights FILE] [--net FILE]\n"
+            "               [--write-weights FILE] [--write-net FILE] [--fps HZ] [--frame-stats]\n"
+            "               [--record FILE] [--db FILE] [--book FILE]\n"
+            "               [--bench-smp [DEPTH]] [--bench-eval] [--bench-mcts [SECONDS]]\n"
+            "       --threads 0 uses every core, --exact sets when the endgame solver takes over,\n"
+            "       --tree sizes the MCTS node pool,\n"
+            "       --weights / --net load 8x8 pattern weights / a network and select that evaluator,\n"
+            "       --write-weights / --write-net save the built-in ones,\n"
+            "       --record appends every game to FILE and resumes one left unfinished there,\n"
+            "       --db shows how the moves fared in a database built by gamedb,\n"
+            "       --book plays from an opening book built by openbook before searching,\n"
+            "       --fps caps the screen updates per second (default 60),\n"
+            "       --frame-stats prints the terminal output per frame after the game" << endl;
+}
+
+int main(int argc, char** argv)
 {
+    int hashMB = 64;
+    int threads = 1;
+    int exactEmpties = -1;
+    int benchDepth = 0;
+    bool benchEval = false;
+    bool frameStats = false;
+    int frameRate = FrameScheduler::DEFAULT_RATE;
+    double benchMcts = 0;
+    size_t treeMB = 128;
+    Algorithm algorithm = Algorithm::ALPHA_BETA;
+    const char* weightsFile = nullptr;
+    const char* netFile = nullptr;
+    const char* evalName = nullptr;
+    const char* recordFile = nullptr;
+    const char* dbFile = nullptr;
+    const char* bookFile = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--hash") == 0 && i + 1 < argc) {
+            hashMB = max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+            if (threads <= 0) threads = max(1u, thread::hardware_concurrency());
+        } else if (strcmp(argv[i], "--exact") == 0 && i + 1 < argc) {
+            exactEmpties = max(0, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--weights") == 0 && i + 1 < argc) {
+            weightsFile = argv[++i];
+        } else if (strcmp(argv[i], "--write-weights") == 0 && i + 1 < argc) {
+            const char* path = argv[++i];
+            if (!PatternEval().save(path)) {
+                cerr << path << ": cannot write" << endl;
+                return 1;
+            }
+            return 0;
+        } else if (strcmp(argv[i], "--net") == 0 && i + 1 < argc) {
+            netFile = argv[++i];
+        } else if (strcmp(argv[i], "--write-net") == 0 && i + 1 < argc) {
+            const char* path = argv[++i];
+            if (!Network().save(path)) {
+                cerr << path << ": cannot write" << endl;
+                return 1;
+            }
+            return 0;
+        } else if (strcmp(argv[i], "--eval") == 0 && i + 1 < argc) {
+            evalName = argv[++i];
+        } else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (strcmp(name, "alphabeta") == 0) algorithm = Algorithm::ALPHA_BETA;
+            else if (strcmp(name, "mcts") == 0) algorithm = Algorithm::MCTS;
+            else {
+                usage();
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--tree") == 0 && i + 1 < argc) {
+            treeMB = max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--bench-mcts") == 0) {
+            benchMcts = 2;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                benchMcts = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordFile = argv[++i];
+        } else if (strcmp(argv[i], "--db") == 0 && i + 1 < argc) {
+            dbFile = argv[++i];
+        } else if (strcmp(argv[i], "--book") == 0 && i + 1 < argc) {
+            bookFile = argv[++i];
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            frameRate = max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--frame-stats") == 0) {
+            frameStats = true;
+        } else if (strcmp(argv[i], "--bench-eval") == 0) {
+            benchEval = true;
+        } else if (strcmp(argv[i], "--bench-smp") == 0) {
+            benchDepth = 12;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                benchDepth = atoi(argv[++i]);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    EvalKind evalKind = EvalKind::SQUARES;
+    if (evalName) {
+        if (strcmp(evalName, "square") == 0) evalKind = EvalKind::SQUARES;
+        else if (strcmp(evalName, "pattern") == 0) evalKind = EvalKind::PATTERNS;
+        else if (strcmp(evalName, "nnue") == 0) evalKind = EvalKind::NNUE;
+        else {
+            usage();
+            return 2;
+        }
+    }
+
+    string error;
+    if (benchEval) {
+        // The game loads --weights and --net into its engine; only the
+        // benchmark needs evaluators of its own
+        PatternEval patterns;
+        Network net;
+        if ((weightsFile && !patterns.load(weightsFile, &error)) || (netFile && !net.load(netFile, &error))) {
+            cerr << error << endl;
+            return 2;
+        }
+        return runEvalBenchmark(patterns, net);
+    }
+    if (benchDepth > 0)
+        return runSmpBenchmark(threads, benchDepth, hashMB);
+    if (benchMcts > 0)
+        return runMctsBenchmark(threads, benchMcts, treeMB);
+
     Game game;
+    if ((weightsFile && !game.loadPatterns(weightsFile, &error)) || (netFile && !game.loadNetwork(netFile, &error))) {
+        cerr << error << endl;
+        return 2;
+    }
+    if (evalName)
+        game.setEvaluator(evalKind);
+    game.setHashSize(hashMB);
+    game.setThreads(threads);
+    game.setAlgorithm(algorithm);
+    game.setTreeSize(treeMB);
+    game.setFrameRate(frameRate);
+    if (recordFile && !game.openRecord(recordFile, &error)) {
+        cerr << error << endl;
+        return 2;
+    }
+    if (bookFile && !game.loadBook(bookFile, &error)) {
+        cerr << error << endl;
+        return 2;
+    }
+    if (dbFile && !game.openDatabase(dbFile, &error)) {
+        cerr << error << endl;
+        return 2;
+    }
+    if (exactEmpties >= 0)
+        game.setExactEmpties(exactEmpties);
     game.run();
+    if (frameStats) {
+        const Renderer::Stats& stats = game.frameStats();
+        clearScreen();
+        cout << "Frames: " << stats.frames << ", " << (stats.frames ? stats.bytes / stats.frames : 0)
+             << " bytes per frame on average, largest " << stats.maxBytes << " bytes" << endl;
+    }
     return 0;
 }
@@ -0,0 +1,32 @@
+#include "mcts.hpp"
+
+using namespace std;
+
+void NodePool::resize(size_t mb)
+{
+    megabytes = mb;
+    nodes.reset();
+    cap = 0;
+    clear();
+}
+
+void NodePool::reserve()
+{
+    if (nodes)
+        return;
+    // Indices are 32 bits wide
+    cap = min<size_t>(max<size_t>(megabytes, 1) * 1024 * 1024 / sizeof(mcts::Node), UINT32_MAX);
+    nodes.reset(new mcts::Node[cap]);
+    clear();
+}
+
+uint32_t NodePool::allocate(uint32_t count)
+{
+    // Check first so a full pool does not keep pushing the counter up
+    if (used.load(memory_order_relaxed) + count > cap)
+        return NONE;
+    uint32_t first = used.fetch_add(count, memory_order_relaxed);
+    if ((size_t)first + count > cap)
+        return NONE;
+    return first;
+}
@@ -0,0 +1,198 @@
+#include "nnue.hpp"
+#include "eval.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+namespace {
+
+constexpr char MAGIC[8] = { 'O', 'T', 'H', 'N', 'N', 'U', 'E', '1' };
+
+struct KernelChoice {
+    nnue::HeadKernel forward;
+    const char* name;
+};
+
+KernelChoice pickKernel(nnue::Kernel want)
+{
+    using nnue::Kernel;
+#ifdef OTHELLO_HAVE_AVX2
+    if ((want == Kernel::AUTO || want == Kernel::AVX2) && __builtin_cpu_supports("avx2"))
+        return { nnue::forwardAvx2, "avx2" };
+#endif
+#ifdef OTHELLO_HAVE_SSE41
+    if ((want == Kernel::AUTO || want == Kernel::SSE4) && __builtin_cpu_supports("sse4.1"))
+        return { nnue::forwardSse4, "sse4.1" };
+#endif
+    (void)want;
+    return { nnue::forwardScalar, "scalar" };
+}
+
+bool scalarRequested()
+{
+    const char* env = getenv("OTHELLO_SIMD");
+    return env && strcmp(env, "scalar") == 0;
+}
+
+KernelChoice kernel = pickKernel(scalarRequested() ? nnue::Kernel::SCALAR : nnue::Kernel::AUTO);
+
+template <class T>
+void readAll(ifstream& in, vector<T>& v)
+{
+    in.read(reinterpret_cast<char*>(v.data()), v.size() * sizeof(T));
+}
+
+template <class T>
+void writeAll(ofstream& out, const vector<T>& v)
+{
+    out.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+}
+
+} // namespace
+
+namespace nnue {
+
+int32_t forwardScalar(const Network& net, const Accumulator& acc)
+{
+    uint8_t a[L1];
+    for (int i = 0; i < L1; i++)
+        a[i] = (uint8_t)clamp<int>(acc.v[i], 0, 127);
+
+    int32_t out = net.bias3();
+    for (int k = 0; k < L2; k++) {
+        const int8_t* w = net.weights2() + k * L1;
+        int32_t sum = net.bias2()[k];
+        for (int i = 0; i < L1; i++)
+            sum += a[i] * w[i];
+        out += clamp(sum >> L2_SHIFT, 0, 127) * net.weights3()[k];
+    }
+    return out;
+}
+
+bool useKernel(Kernel want)
+{
+    kernel = pickKernel(want);
+    return want == Kernel::AUTO || want == Kernel::SCALAR || kernel.forward != forwardScalar;
+}
+
+} // namespace nnue
+
+Network::Network()
+    : b1(nnue::L1, 0), w1(nnue::INPUTS * nnue::L1, 0), b2(nnue::L2, 0), w2(nnue::L2 * nnue::L1, 0), w3(nnue::L2, 0)
+{
+    using namespace nnue;
+
+    // Neuron 0 sums the square weights (a quarter of them) from X's side and
+    // neuron 1 from O's, both around 64 so they stay inside the 0..127 clip.
+    // L2 re-centres their difference the same way and the output takes the
+    // difference again: score = square score for |score| up to about 250.
+    b1[0] = b1[1] = 64;
+    for (int sq = 0; sq < 64; sq++) {
+        int w = SQUARE_WEIGHTS<8>[sq];
+        int q = (w + (w > 0 ? 2 : -2)) / 4;
+        w1[inputOf(sq, Disk::X) * L1 + 0] = (int16_t)q;
+        w1[inputOf(sq, Disk::O) * L1 + 0] = (int16_t)-q;
+        w1[inputOf(sq, Disk::X) * L1 + 1] = (int16_t)-q;
+        w1[inputOf(sq, Disk::O) * L1 + 1] = (int16_t)q;
+    }
+    b2[0] = b2[1] = 64 << L2_SHIFT;
+    w2[0 * L1 + 0] = 32;
+    w2[0 * L1 + 1] = -32;
+    w2[1 * L1 + 0] = -32;
+    w2[1 * L1 + 1] = 32;
+    w3[0] = 32;
+    w3[1] = -32;
+    rebuildFlipColumns();
+}
+
+void Network::rebuildFlipColumns()
+{
+    flip.assign(64 * nnue::L1, 0);
+    for (int sq = 0; sq < 64; sq++) {
+        const int16_t* x = column(nnue::inputOf(sq, Disk::X));
+        const int16_t* o = column(nnue::inputOf(sq, Disk::O));
+        for (int i = 0; i < nnue::L1; i++)
+            flip[sq * nnue::L1 + i] = (int16_t)(x[i] - o[i]);
+    }
+}
+
+bool Network::load(const string& path, string* error)
+{
+    auto fail = [&](const char* why) {
+        if (error) *error = path + ": " + why;
+        return false;
+    };
+
+    ifstream in(path, ios::binary);
+    if (!in)
+        return fail("cannot open");
+
+    char magic[8];
+    uint32_t l1 = 0, l2 = 0;
+    in.read(magic, sizeof magic);
+    in.read(reinterpret_cast<char*>(&l1), sizeof l1);
+    in.read(reinterpret_cast<char*>(&l2), sizeof l2);
+    if (!in || memcmp(magic, MAGIC, sizeof magic) != 0)
+        return fail("not a network file");
+    if (l1 != nnue::L1 || l2 != nnue::L2)
+        return fail("network has different layer sizes");
+
+    Network n;
+    readAll(in, n.b1);
+    readAll(in, n.w1);
+    readAll(in, n.b2);
+    readAll(in, n.w2);
+    in.read(reinterpret_cast<char*>(&n.b3), sizeof n.b3);
+    readAll(in, n.w3);
+    if (!in)
+        return fail("file is truncated");
+
+    n.rebuildFlipColumns();
+    *this = move(n);
+    return true;
+}
+
+bool Network::save(const string& path) const
+{
+    ofstream out(path, ios::binary);
+    uint32_t l1 = nnue::L1, l2 = nnue::L2;
+    out.write(MAGIC, sizeof MAGIC);
+    out.write(reinterpret_cast<const char*>(&l1), sizeof l1);
+    out.write(reinterpret_cast<const char*>(&l2), sizeof l2);
+    writeAll(out, b1);
+    writeAll(out, w1);
+    writeAll(out, b2);
+    writeAll(out, w2);
+    out.write(reinterpret_cast<const char*>(&b3), sizeof b3);
+    writeAll(out, w3);
+    return (bool)out;
+}
+
+void Network::init(nnue::Accumulator& acc, const Board<8>& b) const
+{
+    copy(b1.begin(), b1.end(), acc.v);
+    for (Disk who : { Disk::X, Disk::O }) {
+        for (uint64_t discs = b.discs(who); discs; )
+            add(acc, column(nnue::inputOf(bitboard::popLowest(discs), who)));
+    }
+}
+
+int Network::score(const nnue::Accumulator& acc, Disk side) const
+{
+    int s = kernel.forward(*this, acc) / nnue::OUTPUT_SCALE;
+    return side == Disk::X ? s : -s;
+}
+
+int32_t Network::forward(const nnue::Accumulator& acc) const
+{
+    return kernel.forward(*this, acc);
+}
+
+const char* Network::kernelName() const
+{
+    return kernel.name;
+}
@@ -0,0 +1,59 @@
+// AVX2 head for the neural evaluator. This file is compiled with -mavx2 and is
+// only called after a runtime CPU check (see nnue.cpp).
+#include "nnue.hpp"
+
+#ifdef OTHELLO_HAVE_AVX2
+
+#include <cstring>
+#include <immintrin.h>
+
+namespace nnue {
+
+int32_t forwardAvx2(const Network& net, const Accumulator& acc)
+{
+    constexpr int CHUNKS = L1 / 32;
+
+    // Same steps as the SSE4.1 kernel on 256-bit registers. The pack works per
+    // 128-bit lane, so the 64-bit quarters are put back in order afterwards.
+    const __m256i top = _mm256_set1_epi16(127);
+    __m256i a[CHUNKS];
+    for (int j = 0; j < CHUNKS; j++) {
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc.v + 32 * j));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc.v + 32 * j + 16));
+        __m256i packed = _mm256_packus_epi16(_mm256_min_epi16(lo, top), _mm256_min_epi16(hi, top));
+        a[j] = _mm256_permute4x64_epi64(packed, 0xD8);
+    }
+
+    const __m256i ones = _mm256_set1_epi16(1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i clip = _mm_set1_epi32(127);
+    __m128i out = zero;
+    for (int k = 0; k < L2; k += 4) {
+        __m256i rows[4];
+        for (int r = 0; r < 4; r++) {
+            const int8_t* w = net.weights2() + (k + r) * L1;
+            __m256i sum = _mm256_setzero_si256();
+            for (int j = 0; j < CHUNKS; j++) {
+                __m256i wj = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + 32 * j));
+                sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(a[j], wj), ones));
+            }
+            rows[r] = sum;
+        }
+        // Each lane ends up with the four row sums of its half; add the halves.
+        __m256i quad = _mm256_hadd_epi32(_mm256_hadd_epi32(rows[0], rows[1]), _mm256_hadd_epi32(rows[2], rows[3]));
+        __m128i h = _mm_add_epi32(_mm256_castsi256_si128(quad), _mm256_extracti128_si256(quad, 1));
+        h = _mm_add_epi32(h, _mm_loadu_si128(reinterpret_cast<const __m128i*>(net.bias2() + k)));
+        h = _mm_min_epi32(_mm_max_epi32(_mm_srai_epi32(h, L2_SHIFT), zero), clip);
+
+        int32_t w3;
+        std::memcpy(&w3, net.weights3() + k, sizeof w3);
+        out = _mm_add_epi32(out, _mm_mullo_epi32(h, _mm_cvtepi8_epi32(_mm_cvtsi32_si128(w3))));
+    }
+    out = _mm_hadd_epi32(out, out);
+    out = _mm_hadd_epi32(out, out);
+    return net.bias3() + _mm_cvtsi128_si32(out);
+}
+
+} // namespace nnue
+
+#endif
@@ -0,0 +1,59 @@
+// SSE4.1 head for the neural evaluator. This file is compiled with -msse4.1 and
+// is only called after a runtime CPU check (see nnue.cpp).
+#include "nnue.hpp"
+
+#ifdef OTHELLO_HAVE_SSE41
+
+#include <cstring>
+#include <smmintrin.h>
+
+namespace nnue {
+
+int32_t forwardSse4(const Network& net, const Accumulator& acc)
+{
+    constexpr int CHUNKS = L1 / 16;
+
+    // Clip the accumulator to 0..127 and pack it to bytes: min caps the top,
+    // the unsigned-saturating pack takes care of negatives.
+    const __m128i top = _mm_set1_epi16(127);
+    __m128i a[CHUNKS];
+    for (int j = 0; j < CHUNKS; j++) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc.v + 16 * j));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc.v + 16 * j + 8));
+        a[j] = _mm_packus_epi16(_mm_min_epi16(lo, top), _mm_min_epi16(hi, top));
+    }
+
+    // Four L2 rows at a time: u8 x i8 products summed pairwise to i16 (no
+    // saturation with 0..127 inputs), widened to i32, then the four rows are
+    // reduced together with horizontal adds.
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i clip = _mm_set1_epi32(127);
+    __m128i out = zero;
+    for (int k = 0; k < L2; k += 4) {
+        __m128i rows[4];
+        for (int r = 0; r < 4; r++) {
+            const int8_t* w = net.weights2() + (k + r) * L1;
+            __m128i sum = zero;
+            for (int j = 0; j < CHUNKS; j++) {
+                __m128i wj = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + 16 * j));
+                sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(a[j], wj), ones));
+            }
+            rows[r] = sum;
+        }
+        __m128i h = _mm_hadd_epi32(_mm_hadd_epi32(rows[0], rows[1]), _mm_hadd_epi32(rows[2], rows[3]));
+        h = _mm_add_epi32(h, _mm_loadu_si128(reinterpret_cast<const __m128i*>(net.bias2() + k)));
+        h = _mm_min_epi32(_mm_max_epi32(_mm_srai_epi32(h, L2_SHIFT), zero), clip);
+
+        int32_t w3;
+        std::memcpy(&w3, net.weights3() + k, sizeof w3);
+        out = _mm_add_epi32(out, _mm_mullo_epi32(h, _mm_cvtepi8_epi32(_mm_cvtsi32_si128(w3))));
+    }
+    out = _mm_hadd_epi32(out, out);
+    out = _mm_hadd_epi32(out, out);
+    return net.bias3() + _mm_cvtsi128_si32(out);
+}
+
+} // namespace nnue
+
+#endif
@@ -0,0 +1,79 @@
+#include "notation.hpp"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+
+using namespace std;
+
+bool parseMoves(const string& text, int size, vector<uint8_t>& squares, string* bad)
+{
+    squares.clear();
+    const char* p = text.c_str();
+    while (*p) {
+        if (isspace((unsigned char)*p)) {
+            p++;
+            continue;
+        }
+        const char* start = p;
+        int x = tolower((unsigned char)*p) - 'a';
+        long y = -1;
+        char* end = const_cast<char*>(p + 1);
+        // strtol rather than stoi: a run of digits too long for an int is
+        // just a bad square, not an exception
+        if (isdigit((unsigned char)p[1])) {
+            errno = 0;
+            y = strtol(p + 1, &end, 10) - 1;
+            if (errno == ERANGE)
+                y = -1;
+        }
+        if (x < 0 || x >= size || y < 0 || y >= size) {
+            if (bad)
+                *bad = string(start, isdigit((unsigned char)p[1]) ? end : p + 1);
+            return false;
+        }
+        squares.push_back((uint8_t)(y * size + x));
+        p = end;
+    }
+    return true;
+}
+
+bool playMoves(AnyBoard& board, const vector<uint8_t>& squares, Disk& side, size_t* illegal)
+{
+    int size = board.getSize();
+    side = Disk::X;
+    for (size_t i = 0; i < squares.size(); i++) {
+        if (board.getValid(side).empty())
+            side = opponent(side);
+        int x = squares[i] % size, y = squares[i] / size;
+        if (!board.isValid(x, y, side)) {
+            if (illegal)
+                *illegal = i;
+            return false;
+        }
+        board.put(x, y, side);
+        side = opponent(side);
+    }
+    if (board.getValid(side).empty())
+        side = opponent(side);
+    return true;
+}
+
+bool playMoves(AnyBoard& board, const string& text, Disk& side, string* error)
+{
+    vector<uint8_t> squares;
+    string bad;
+    size_t illegal;
+    if (!parseMoves(text, board.getSize(), squares, &bad)) {
+        if (error)
+            *error = "not a square: " + bad;
+        return false;
+    }
+    if (!playMoves(board, squares, side, &illegal)) {
+        int size = board.getSize();
+        if (error)
+            *error = "illegal move " + string(1, (char)('a' + squares[illegal] % size)) + to_string(squares[illegal] / size + 1);
+        return false;
+    }
+    return true;
+}
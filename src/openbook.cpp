@@ -0,0 +1,162 @@
+// openbook: builds the opening book that Othello --book plays from, and looks
+// positions up in it.
+//
+//   openbook build BOOK [--size N] [--plies P] [--depth D] [--deviation E]
+//                       [--budget E] [--db FILE] [--min-games G] [--from BOOK]
+//                       [--threads T] [--hash MB] [--eval square|pattern|nnue]
+//   openbook query BOOK [MOVES]      e.g. f5d6c3; passes are implied
+//   openbook info BOOK
+//
+// See BookBuildOptions for what the build options mean.
+
+#include "engine.hpp"
+#include "game_db.hpp"
+#include "notation.hpp"
+#include "opening_book.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static void usage()
+{
+    cerr << "usage: openbook build BOOK [--size 8|10|12] [--plies P] [--depth D] [--deviation E]\n"
+            "                           [--budget E] [--db FILE] [--min-games G] [--from BOOK]\n"
+            "                           [--threads T] [--hash MB] [--eval square|pattern|nnue]\n"
+            "       openbook query BOOK [MOVES]\n"
+            "       openbook info BOOK" << endl;
+}
+
+static int build(const string& path, const vector<string>& args)
+{
+    BookBuildOptions options;
+    int threads = 1, hashMB = 64;
+    EvalKind eval = EvalKind::SQUARES;
+    string dbPath;
+    for (size_t i = 0; i < args.size(); i++) {
+        const string& a = args[i];
+        bool value = i + 1 < args.size();
+        if (a == "--size" && value) options.boardSize = atoi(args[++i].c_str());
+        else if (a == "--plies" && value) options.plies = atoi(args[++i].c_str());
+        else if (a == "--depth" && value) options.depth = max(1, min(60, atoi(args[++i].c_str())));
+        else if (a == "--deviation" && value) options.deviation = atoi(args[++i].c_str());
+        else if (a == "--budget" && value) options.budget = atoi(args[++i].c_str());
+        else if (a == "--db" && value) dbPath = args[++i];
+        else if (a == "--min-games" && value) options.minGames = (uint32_t)atoi(args[++i].c_str());
+        else if (a == "--from" && value) options.base = args[++i];
+        else if (a == "--threads" && value) threads = atoi(args[++i].c_str());
+        else if (a == "--hash" && value) hashMB = max(1, atoi(args[++i].c_str()));
+        else if (a == "--eval" && value) {
+            string e = args[++i];
+            if (e == "square") eval = EvalKind::SQUARES;
+            else if (e == "pattern") eval = EvalKind::PATTERNS;
+            else if (e == "nnue") eval = EvalKind::NNUE;
+            else {
+                usage();
+                return 2;
+            }
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    string error;
+    GameDb db;
+    if (!dbPath.empty()) {
+        if (!db.open(dbPath, &error)) {
+            cerr << error << endl;
+            return 1;
+        }
+        options.db = &db;
+    }
+    Engine engine(hashMB, threads);
+    engine.setEvaluator(eval);
+
+    BookBuildStats stats;
+    bool reported = false;
+    bool ok = buildBook(options, engine, path, stats, &error, [&](const BookBuildStats& s) {
+        cerr << "\r" << s.positions << " positions, " << s.searches << " searches" << flush;
+        reported = true;
+    });
+    if (reported)
+        cerr << endl;
+    if (!ok) {
+        cerr << error << endl;
+        return 1;
+    }
+    cout << path << ": " << stats.positions << " positions, " << stats.searches << " searches at depth "
+         << options.depth << ", " << stats.reused << " values from the base book, "
+         << fixed << setprecision(1) << stats.seconds << " s" << endl;
+    return 0;
+}
+
+static int query(const string& path, const vector<string>& args)
+{
+    // Opening the book is all the game pays for it at startup
+    auto start = chrono::steady_clock::now();
+    OpeningBook book;
+    string error;
+    if (!book.open(path, &error)) {
+        cerr << error << endl;
+        return 1;
+    }
+    double openMicros = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+
+    int size = book.boardSize();
+    string moves;
+    for (const string& a : args)
+        moves += a;
+    AnyBoard board(size);
+    Disk side;
+    if (!playMoves(board, moves, side, &error)) {
+        cerr << error << endl;
+        return 1;
+    }
+
+    start = chrono::steady_clock::now();
+    BookMove hit;
+    bool found = book.probe(board, side, hit);
+    double probeMicros = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+
+    cout << "open " << fixed << setprecision(1) << openMicros << " us, first probe " << probeMicros << " us" << endl;
+    if (!found) {
+        cout << "not in the book" << endl;
+        return 0;
+    }
+    cout << (side == Disk::X ? "X" : "O") << " plays " << char('a' + hit.move % size) << hit.move / size + 1
+         << ", score " << hit.score << " (depth " << hit.depth << ")" << endl;
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        usage();
+        return 2;
+    }
+    string command = argv[1], path = argv[2];
+    vector<string> args(argv + 3, argv + argc);
+    if (command == "build")
+        return build(path, args);
+    if (command == "query")
+        return query(path, args);
+    if (command != "info") {
+        usage();
+        return 2;
+    }
+    OpeningBook book;
+    string error;
+    if (!book.open(path, &error)) {
+        cerr << error << endl;
+        return 1;
+    }
+    cout << path << ": " << book.boardSize() << "x" << book.boardSize() << ", "
+         << book.positions() << " positions" << endl;
+    return 0;
+}
@@ -0,0 +1,326 @@
+#include "opening_book.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "engine.hpp"
+#include "eval.hpp"
+#include "file_io.hpp"
+#include "game_db.hpp"
+#include "symmetry.hpp"
+
+using namespace std;
+
+namespace {
+
+const char MAGIC[8] = { 'O', 'T', 'H', 'B', 'O', 'O', 'K', '1' };
+
+struct BookHeader {
+    char magic[8];
+    uint32_t boardSize;
+    uint32_t reserved;
+    uint64_t count;
+    uint64_t reserved2;
+};
+
+// Interpolation steps before a lookup falls back to bisection, in case the
+// keys are not as uniform as they should be
+constexpr int INTERPOLATION_STEPS = 8;
+
+uint64_t canonicalKey(const AnyBoard& board, Disk side, int* image)
+{
+    return board.visit([&](const auto& b) { return symmetry::canonicalKey(b, side, image); });
+}
+
+// Square sq seen through symmetry s, on a board of any size
+int transformSquare(int size, int sq, int s)
+{
+    switch (size) {
+        case 8: return symmetry::transform<8>(sq, s);
+        case 10: return symmetry::transform<10>(sq, s);
+        default: return symmetry::transform<12>(sq, s);
+    }
+}
+
+class BookBuilder {
+public:
+    BookBuilder(const BookBuildOptions& options, Engine& engine, BookBuildStats& stats,
+                const function<void(const BookBuildStats&)>& progress)
+        : options(options), engine(engine), stats(stats), progress(progress)
+    {
+        limits.maxDepth = options.depth;
+        limits.seconds = 1e9;   // the depth is the limit
+    }
+
+    void addBase(const BookEntry* entries, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+            book[entries[i].key] = entries[i];
+    }
+
+    // Negamax value of the book line from here, for `side`
+    int expand(AnyBoard& board, Disk side, int ply, int budget)
+    {
+        vector<pair<int, int>> moves = board.getValid(side);
+        if (moves.empty()) {
+            if (board.getValid(opponent(side)).empty())
+                return exactScore(board.count(side) - board.count(opponent(side)));
+            return -expand(board, opponent(side), ply, budget);
+        }
+        if (ply >= options.plies)
+            return value(board, side);
+
+        int image;
+        uint64_t key = canonicalKey(board, side, &image);
+        if (expanded.count(key))
+            return book[key].score;     // reached again by transposition
+
+        int n = (int)moves.size();
+        vector<int> scores(n);
+        for (int i = 0; i < n; i++) {
+            board.put(moves[i].first, moves[i].second, side);
+            scores[i] = -value(board, opponent(side));
+            board.undo();
+        }
+        int best = *max_element(scores.begin(), scores.end());
+
+        vector<bool> popular(n, false);
+        if (options.db) {
+            for (const MoveStats& m : options.db->moveStats(board, side))
+                for (int i = 0; i < n; i++)
+                    if (moves[i].first == m.x && moves[i].second == m.y)
+                        popular[i] = m.games >= options.minGames;
+        }
+
+        // Follow the best move and the ones close enough to it
+        for (int i = 0; i < n; i++) {
+            int loss = best - scores[i];
+            if ((loss > options.deviation || loss > budget) && !popular[i])
+                continue;
+            board.put(moves[i].first, moves[i].second, side);
+            scores[i] = -expand(board, opponent(side), ply + 1, max(0, budget - loss));
+            board.undo();
+        }
+
+        int chosen = (int)(max_element(scores.begin(), scores.end()) - scores.begin());
+        int size = board.getSize();
+        int square = moves[chosen].second * size + moves[chosen].first;
+        BookEntry& e = book[key];
+        e = { key, scores[chosen], (uint8_t)transformSquare(size, square, image), (uint8_t)options.depth, 0 };
+        expanded.insert(key);
+        stats.positions = book.size();
+        report();
+        return scores[chosen];
+    }
+
+    vector<BookEntry> entries() const
+    {
+        vector<BookEntry> out;
+        out.reserve(book.size());
+        for (const auto& kv : book)
+            out.push_back(kv.second);
+        sort(out.begin(), out.end(), [](const BookEntry& a, const BookEntry& b) { return a.key < b.key; });
+        return out;
+    }
+
+private:
+    const BookBuildOptions& options;
+    Engine& engine;
+    BookBuildStats& stats;
+    const function<void(const BookBuildStats&)>& progress;
+    SearchLimits limits;
+    unordered_map<uint64_t, BookEntry> book;
+    unordered_set<uint64_t> expanded;           // book positions added by this build
+    unordered_map<uint64_t, int> searched;      // values found by search or in the base book
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    chrono::steady_clock::time_point lastReport = start;
+
+    // Value of a position for `side`, from the book or a search
+    int value(AnyBoard& board, Disk side)
+    {
+        if (board.getValid(side).empty()) {
+            if (board.getValid(opponent(side)).empty())
+                return exactScore(board.count(side) - board.count(opponent(side)));
+            return -value(board, opponent(side));
+        }
+        uint64_t key = canonicalKey(board, side, nullptr);
+        if (expanded.count(key))
+            return book[key].score;
+        auto found = searched.find(key);
+        if (found != searched.end())
+            return found->second;
+        auto known = book.find(key);
+        if (known != book.end() && known->second.depth >= options.depth) {
+            stats.reused++;
+            return searched[key] = known->second.score;
+        }
+        int score = engine.think(board, side, limits).score;
+        searched[key] = score;
+        stats.searches++;
+        report();
+        return score;
+    }
+
+    void report()
+    {
+        auto now = chrono::steady_clock::now();
+        stats.seconds = chrono::duration<double>(now - start).count();
+        if (progress && now - lastReport >= chrono::seconds(1)) {
+            lastReport = now;
+            progress(stats);
+        }
+    }
+};
+
+} // namespace
+
+OpeningBook::~OpeningBook()
+{
+    close();
+}
+
+bool OpeningBook::open(const string& path, string* error)
+{
+    auto fail = [&](const char* why) {
+        if (error) *error = path + ": " + why;
+        close();
+        return false;
+    };
+
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return fail(strerror(errno));
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(BookHeader)) {
+        ::close(fd);
+        return fail("not an opening book");
+    }
+    void* map = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+        return fail(strerror(errno));
+    base = static_cast<const uint8_t*>(map);
+    length = (size_t)st.st_size;
+    // Lookups jump around the file: reading ahead would only waste the cache
+    madvise(map, length, MADV_RANDOM);
+
+    const BookHeader* h = reinterpret_cast<const BookHeader*>(base);
+    if (memcmp(h->magic, MAGIC, sizeof MAGIC) != 0)
+        return fail("not an opening book");
+    if ((h->boardSize != 8 && h->boardSize != 10 && h->boardSize != 12) ||
+        h->count > (length - sizeof(BookHeader)) / sizeof(BookEntry))
+        return fail("opening book is damaged");
+    size = (int)h->boardSize;
+    count = (size_t)h->count;
+    entries = reinterpret_cast<const BookEntry*>(base + sizeof(BookHeader));
+    return true;
+}
+
+void OpeningBook::close()
+{
+    if (base)
+        munmap((void*)base, length);
+    base = nullptr;
+    length = 0;
+    entries = nullptr;
+    count = 0;
+    size = 0;
+}
+
+const BookEntry* OpeningBook::find(uint64_t key) const
+{
+    size_t lo = 0, hi = count;
+    for (int step = 0; lo < hi; step++) {
+        uint64_t first = entries[lo].key, last = entries[hi - 1].key;
+        if (key < first || key > last)
+            return nullptr;
+        size_t mid = lo + (hi - lo) / 2;
+        if (step < INTERPOLATION_STEPS && last > first)
+            mid = lo + (size_t)((unsigned __int128)(key - first) * (hi - 1 - lo) / (last - first));
+        if (entries[mid].key == key)
+            return &entries[mid];
+        if (entries[mid].key < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return nullptr;
+}
+
+bool OpeningBook::probe(const AnyBoard& board, Disk side, BookMove& out) const
+{
+    if (!base || board.getSize() != size)
+        return false;
+    return board.visit([&](const auto& b) {
+        constexpr int N = std::decay_t<decltype(b)>::SIZE;
+        int image;
+        const BookEntry* e = find(symmetry::canonicalKey(b, side, &image));
+        if (!e || e->move >= N * N)
+            return false;
+        int sq = symmetry::transform<N>(e->move, symmetry::inverse(image));
+        if (!bitboard::test(b.moves(side), sq))
+            return false;   // a key collision
+        out.move = sq;
+        out.score = e->score;
+        out.depth = e->depth;
+        return true;
+    });
+}
+
+bool buildBook(const BookBuildOptions& options, Engine& engine, const string& output,
+               BookBuildStats& stats, string* error, const function<void(const BookBuildStats&)>& progress)
+{
+    auto fail = [&](const string& why) {
+        if (error) *error = why;
+        return false;
+    };
+    stats = BookBuildStats();
+    if (options.boardSize != 8 && options.boardSize != 10 && options.boardSize != 12)
+        return fail("board size must be 8, 10 or 12");
+
+    BookBuilder builder(options, engine, stats, progress);
+    if (!options.base.empty()) {
+        OpeningBook base;
+        if (!base.open(options.base, error))
+            return false;
+        if (base.boardSize() != options.boardSize)
+            return fail(options.base + ": the book is for another board size");
+        // Copied out, so the output may replace the base file
+        builder.addBase(base.data(), base.positions());
+    }
+
+    AnyBoard board(options.boardSize);
+    builder.expand(board, Disk::X, 0, options.budget);
+    vector<BookEntry> entries = builder.entries();
+
+    BookHeader header = {};
+    memcpy(header.magic, MAGIC, sizeof MAGIC);
+    header.boardSize = (uint32_t)options.boardSize;
+    header.count = entries.size();
+
+    string temp = output + ".tmp";
+    int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return fail(temp + ": " + strerror(errno));
+    bool ok = writeAll(fd, &header, sizeof header) &&
+              writeAll(fd, entries.data(), entries.size() * sizeof(BookEntry)) &&
+              fdatasync(fd) == 0;
+    ::close(fd);
+    if (!ok || rename(temp.c_str(), output.c_str()) != 0) {
+        unlink(temp.c_str());
+        return fail(output + ": " + strerror(errno));
+    }
+    stats.positions = entries.size();
+    return true;
+}
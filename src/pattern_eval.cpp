@@ -0,0 +1,175 @@
+#include "pattern_eval.hpp"
+#include "eval.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+namespace {
+
+constexpr char MAGIC[8] = { 'O', 'T', 'H', 'P', 'A', 'T', '0', '1' };
+
+constexpr bool layoutFits()
+{
+    int inst = 0;
+    for (int s = 0; s < patterns::SHAPES; s++)
+        inst += patterns::SHAPE_SYMMETRIES[s];
+    if (inst != patterns::INSTANCES)
+        return false;
+    for (const auto& r : patterns::LAYOUT.refs)
+        if (r.count > 8)
+            return false;
+    return true;
+}
+static_assert(layoutFits(), "pattern layout does not match INSTANCES or SquareRefs");
+
+// Start of each shape's table inside one phase.
+array<int, patterns::SHAPES + 1> shapeOffsets()
+{
+    array<int, patterns::SHAPES + 1> off{};
+    for (int s = 0; s < patterns::SHAPES; s++)
+        off[s + 1] = off[s] + patterns::pow3(patterns::SHAPE_DEFS[s].length);
+    return off;
+}
+
+patterns::BatchKernel pickBatch(bool scalar)
+{
+#ifdef OTHELLO_HAVE_AVX2
+    if (!scalar && __builtin_cpu_supports("avx2"))
+        return patterns::scoreBatchAvx2;
+#endif
+    (void)scalar;
+    return patterns::scoreBatchScalar;
+}
+
+bool scalarRequested()
+{
+    const char* env = getenv("OTHELLO_SIMD");
+    return env && strcmp(env, "scalar") == 0;
+}
+
+patterns::BatchKernel batchKernel = pickBatch(scalarRequested());
+
+} // namespace
+
+namespace patterns {
+
+void scoreBatchScalar(const PatternEval& eval, const PatternFeatures* f, const uint8_t* phase, int n, int32_t* out)
+{
+    const auto& offsets = eval.slotOffsets();
+    for (int p = 0; p < n; p++) {
+        const int16_t* w = eval.weightData() + phase[p] * eval.phaseStride();
+        int32_t sum = 0;
+        for (int i = 0; i < INSTANCES; i++)
+            sum += w[offsets[i] + f[p].idx[i]];
+        out[p] = sum;
+    }
+}
+
+void useScalarBatch(bool scalar)
+{
+    batchKernel = pickBatch(scalar);
+}
+
+} // namespace patterns
+
+PatternEval::PatternEval()
+{
+    using namespace patterns;
+
+    auto shapeOff = shapeOffsets();
+    int total = shapeOff[SHAPES];
+    stride = total + 1; // the last entry stays 0 for the padding slots
+    weights.assign(PHASES * stride + 1, 0);
+
+    for (int i = 0; i < SLOTS; i++)
+        offsets[i] = i < INSTANCES ? shapeOff[LAYOUT.shapeOf[i]] : total;
+
+    // Each square's weight is spread evenly over the instances that read it.
+    // Every orientation of a shape covers its squares equally often, so the
+    // canonical squares give the share for all of them.
+    for (int s = 0; s < SHAPES; s++) {
+        const ShapeDef& def = SHAPE_DEFS[s];
+        for (int index = 0; index < pow3(def.length); index++) {
+            int value = 0;
+            for (int i = 0, rest = index; i < def.length; i++, rest /= 3) {
+                int sq = def.squares[i];
+                int share = SQUARE_WEIGHTS<8>[sq] * WEIGHT_SCALE / LAYOUT.refs[sq].count;
+                if (rest % 3 == 1) value += share;
+                else if (rest % 3 == 2) value -= share;
+            }
+            for (int ph = 0; ph < PHASES; ph++)
+                weights[ph * stride + shapeOff[s] + index] = (int16_t)value;
+        }
+    }
+}
+
+bool PatternEval::load(const string& path, string* error)
+{
+    auto fail = [&](const char* why) {
+        if (error) *error = path + ": " + why;
+        return false;
+    };
+
+    ifstream in(path, ios::binary);
+    if (!in)
+        return fail("cannot open");
+
+    char magic[8];
+    uint32_t phases = 0, entries = 0;
+    in.read(magic, sizeof magic);
+    in.read(reinterpret_cast<char*>(&phases), sizeof phases);
+    in.read(reinterpret_cast<char*>(&entries), sizeof entries);
+    if (!in || memcmp(magic, MAGIC, sizeof magic) != 0)
+        return fail("not a pattern weights file");
+    if (phases != patterns::PHASES || (int)entries != stride - 1)
+        return fail("weights are for a different pattern set");
+
+    vector<int16_t> loaded(weights.size(), 0);
+    for (int ph = 0; ph < patterns::PHASES; ph++)
+        in.read(reinterpret_cast<char*>(loaded.data() + ph * stride), entries * sizeof(int16_t));
+    if (!in)
+        return fail("file is truncated");
+
+    weights.swap(loaded);
+    return true;
+}
+
+bool PatternEval::save(const string& path) const
+{
+    ofstream out(path, ios::binary);
+    uint32_t phases = patterns::PHASES, entries = stride - 1;
+    out.write(MAGIC, sizeof MAGIC);
+    out.write(reinterpret_cast<const char*>(&phases), sizeof phases);
+    out.write(reinterpret_cast<const char*>(&entries), sizeof entries);
+    for (int ph = 0; ph < patterns::PHASES; ph++)
+        out.write(reinterpret_cast<const char*>(weights.data() + ph * stride), entries * sizeof(int16_t));
+    return (bool)out;
+}
+
+void PatternEval::init(PatternFeatures& f, const Board<8>& b)
+{
+    memset(&f, 0, sizeof f);
+    for (int inst = 0; inst < patterns::INSTANCES; inst++) {
+        const patterns::ShapeDef& def = patterns::SHAPE_DEFS[patterns::LAYOUT.shapeOf[inst]];
+        int index = 0;
+        for (int i = def.length - 1; i >= 0; i--) {
+            int sq = patterns::LAYOUT.squareOf[inst][i];
+            Disk d = b.get(sq % 8, sq / 8);
+            index = index * 3 + (d == Disk::X ? 1 : d == Disk::O ? 2 : 0);
+        }
+        f.idx[inst] = (uint16_t)index;
+    }
+}
+
+void PatternEval::scoreBatch(const PatternFeatures* f, const uint8_t* phase, int n, int32_t* out) const
+{
+    batchKernel(*this, f, phase, n, out);
+}
+
+const char* PatternEval::batchKernelName() const
+{
+    return batchKernel == patterns::scoreBatchScalar ? "scalar" : "avx2";
+}
@@ -0,0 +1,41 @@
+// AVX2 batch scoring for the pattern evaluator. This file is compiled with
+// -mavx2 and is only called after a runtime CPU check (see pattern_eval.cpp).
+#include "pattern_eval.hpp"
+
+#ifdef OTHELLO_HAVE_AVX2
+
+#include <immintrin.h>
+
+namespace patterns {
+
+// Eight pattern slots per gather: the 16-bit indices are widened, offset into the
+// phase's table and used to gather 32 bits at each int16 weight; the upper half
+// belongs to the next weight and is shifted out.
+void scoreBatchAvx2(const PatternEval& eval, const PatternFeatures* f, const uint8_t* phase, int n, int32_t* out)
+{
+    const int* table = reinterpret_cast<const int*>(eval.weightData());
+    const int32_t* offsets = eval.slotOffsets().data();
+
+    __m256i slotOffset[SLOTS / 8];
+    for (int k = 0; k < SLOTS / 8; k++)
+        slotOffset[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsets + 8 * k));
+
+    for (int p = 0; p < n; p++) {
+        __m256i base = _mm256_set1_epi32(phase[p] * eval.phaseStride());
+        __m256i acc = _mm256_setzero_si256();
+        for (int k = 0; k < SLOTS / 8; k++) {
+            __m128i idx16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(f[p].idx + 8 * k));
+            __m256i idx = _mm256_add_epi32(_mm256_add_epi32(_mm256_cvtepu16_epi32(idx16), slotOffset[k]), base);
+            __m256i w = _mm256_i32gather_epi32(table, idx, 2);
+            acc = _mm256_add_epi32(acc, _mm256_srai_epi32(_mm256_slli_epi32(w, 16), 16));
+        }
+        __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        out[p] = _mm_cvtsi128_si32(sum);
+    }
+}
+
+} // namespace patterns
+
+#endif
@@ -0,0 +1,257 @@
+// perft: counts the leaf nodes of the game tree to a fixed depth.
+// This is the throughput benchmark for the move generators and, with --verify,
+// the correctness check of every bitboard backend against ScanBoard<N>.
+//
+//   perft [--size 8|10|12|all] [--depth D] [--threads T] [--verify] [--scalar]
+//         [--position CELLS TURN]
+//
+// --threads 0 uses every core. CELLS is N*N characters ('X', 'O', '.' or '-')
+// row by row, TURN is X or O.
+// A pass counts as one ply, and a finished game counts as a single leaf, which
+// matches how Game::run hands the turn over.
+
+#include "board.hpp"
+#include "scan_board.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+struct Options {
+    int size = 0;           // 0 = every supported size
+    int depth = 0;          // 0 = per-size default
+    int threads = 1;
+    bool verify = false;
+    bool scalar = false;
+    string cells;
+    Disk turn = Disk::X;
+};
+
+template <class B>
+struct Node {
+    B board;
+    Disk turn;
+};
+
+// Bitboard perft: moves come as a mask and the last ply is a popcount.
+template <int N>
+uint64_t perft(const Board<N>& b, Disk turn, int depth)
+{
+    using Bits = typename Board<N>::Bits;
+
+    if (depth == 0)
+        return 1;
+    Bits moves = b.moves(turn);
+    if (!bitboard::any(moves)) {
+        if (!bitboard::any(b.moves(opponent(turn))))
+            return 1; // game over
+        return perft(b, opponent(turn), depth - 1);
+    }
+    if (depth == 1)
+        return bitboard::popcount(moves);
+
+    uint64_t nodes = 0;
+    while (bitboard::any(moves)) {
+        Board<N> child = b;
+        child.play(bitboard::popLowest(moves), turn);
+        nodes += perft(child, opponent(turn), depth - 1);
+    }
+    return nodes;
+}
+
+// Reference perft on the mailbox scanner, one getValid call per node.
+template <int N>
+uint64_t perft(const ScanBoard<N>& b, Disk turn, int depth)
+{
+    if (depth == 0)
+        return 1;
+    auto valid = b.getValid(turn);
+    if (valid.empty()) {
+        if (b.getValid(opponent(turn)).empty())
+            return 1;
+        return perft(b, opponent(turn), depth - 1);
+    }
+    if (depth == 1)
+        return valid.size();
+
+    uint64_t nodes = 0;
+    for (auto& m : valid) {
+        ScanBoard<N> child = b;
+        child.put(m.first, m.second, turn);
+        nodes += perft(child, opponent(turn), depth - 1);
+    }
+    return nodes;
+}
+
+template <class B>
+void expand(const Node<B>& n, int depth, vector<Node<B>>& out, uint64_t& finished)
+{
+    if (depth == 0) {
+        out.push_back(n);
+        return;
+    }
+    auto valid = n.board.getValid(n.turn);
+    if (valid.empty()) {
+        if (n.board.getValid(opponent(n.turn)).empty()) {
+            finished++;
+            return;
+        }
+        expand(Node<B>{ n.board, opponent(n.turn) }, depth - 1, out, finished);
+        return;
+    }
+    for (auto& m : valid) {
+        Node<B> child = n;
+        child.board.put(m.first, m.second, n.turn);
+        child.turn = opponent(n.turn);
+        expand(child, depth - 1, out, finished);
+    }
+}
+
+// Splits the tree a few plies below the root and hands the subtrees to worker
+// threads through a shared counter, so uneven subtrees still balance out.
+template <class B>
+uint64_t perftParallel(const B& root, Disk turn, int depth, int threads)
+{
+    if (threads <= 1 || depth < 4)
+        return perft(root, turn, depth);
+
+    int split = depth >= 6 ? 3 : 2;
+    vector<Node<B>> tasks;
+    uint64_t finished = 0;
+    expand(Node<B>{ root, turn }, split, tasks, finished);
+
+    atomic<size_t> next{ 0 };
+    atomic<uint64_t> total{ finished };
+    vector<thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&] {
+            uint64_t local = 0;
+            for (size_t i; (i = next.fetch_add(1)) < tasks.size(); )
+                local += perft(tasks[i].board, tasks[i].turn, depth - split);
+            total += local;
+        });
+    }
+    for (auto& th : pool)
+        th.join();
+    return total;
+}
+
+template <class B>
+bool loadPosition(B& b, const string& cells)
+{
+    constexpr int N = B::SIZE;
+    if ((int)cells.size() != N * N)
+        return false;
+    for (int i = 0; i < N * N; i++) {
+        char c = cells[i];
+        Disk d = (c == 'X' || c == 'x') ? Disk::X : (c == 'O' || c == 'o') ? Disk::O : Disk::Empty;
+        b.set(i % N, i / N, d);
+    }
+    return true;
+}
+
+static double secondsSince(chrono::steady_clock::time_point t0)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+template <int N>
+bool runSize(const Options& opt)
+{
+    Board<N> fast;
+    ScanBoard<N> ref;
+    if (!opt.cells.empty()) {
+        if (!loadPosition(fast, opt.cells) || !loadPosition(ref, opt.cells)) {
+            cerr << "position does not have " << N * N << " cells" << endl;
+            return false;
+        }
+    }
+
+    int maxDepth = opt.depth > 0 ? opt.depth : (N == 8 ? 9 : 7);
+    const char* kernel = N == 8 ? "u64" : N == 10 ? widebits::kernels10.name : widebits::kernels12.name;
+    bool ok = true;
+
+    for (int d = 1; d <= maxDepth; d++) {
+        auto t0 = chrono::steady_clock::now();
+        uint64_t nodes = perftParallel(fast, opt.turn, d, opt.threads);
+        double secs = secondsSince(t0);
+
+        cout << setw(2) << N << "x" << setw(2) << left << N << right
+             << "  depth " << setw(2) << d
+             << "  nodes " << setw(14) << nodes
+             << "  " << fixed << setprecision(3) << setw(8) << secs << " s"
+             << "  " << setprecision(1) << setw(8) << (secs > 0 ? nodes / secs / 1e6 : 0.0) << " Mnps"
+             << "  [" << kernel << ", " << opt.threads << "T]";
+
+        if (opt.verify) {
+            auto r0 = chrono::steady_clock::now();
+            uint64_t expected = perftParallel(ref, opt.turn, d, opt.threads);
+            double refSecs = secondsSince(r0);
+            bool same = expected == nodes;
+            ok = ok && same;
+            cout << "  scan " << expected << (same ? " OK" : " MISMATCH")
+                 << " (" << setprecision(1) << (secs > 0 ? refSecs / secs : 0.0) << "x)";
+        }
+        cout << endl;
+    }
+    return ok;
+}
+
+static void usage()
+{
+    cerr << "usage: perft [--size 8|10|12|all] [--depth D] [--threads T] [--verify] [--scalar]\n"
+            "             [--position CELLS X|O]" << endl;
+}
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        string a = argv[i];
+        if (a == "--size" && i + 1 < argc) {
+            string v = argv[++i];
+            opt.size = v == "all" ? 0 : atoi(v.c_str());
+        } else if (a == "--depth" && i + 1 < argc) {
+            opt.depth = atoi(argv[++i]);
+        } else if (a == "--threads" && i + 1 < argc) {
+            opt.threads = atoi(argv[++i]);
+            if (opt.threads <= 0) opt.threads = (int)thread::hardware_concurrency();
+        } else if (a == "--verify") {
+            opt.verify = true;
+        } else if (a == "--scalar") {
+            opt.scalar = true;
+        } else if (a == "--position" && i + 2 < argc) {
+            opt.cells = argv[++i];
+            opt.turn = (argv[++i][0] == 'O' || argv[i][0] == 'o') ? Disk::O : Disk::X;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (opt.threads < 1) opt.threads = 1;
+    if (!opt.cells.empty() && opt.size == 0) {
+        size_t n = opt.cells.size();
+        opt.size = n == 64 ? 8 : n == 100 ? 10 : n == 144 ? 12 : -1;
+    }
+    if (opt.size != 0 && opt.size != 8 && opt.size != 10 && opt.size != 12) {
+        usage();
+        return 2;
+    }
+    if (opt.scalar)
+        widebits::useScalarKernels(true);
+
+    bool ok = true;
+    if (opt.size == 0 || opt.size == 8) ok = runSize<8>(opt) && ok;
+    if (opt.size == 0 || opt.size == 10) ok = runSize<10>(opt) && ok;
+    if (opt.size == 0 || opt.size == 12) ok = runSize<12>(opt) && ok;
+    return ok ? 0 : 1;
+}
@@ -1,11 +1,17 @@
 #include "renderer.hpp"
 
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
-#include <set>
-#include <iomanip>
 
 using namespace std;
 
+// Right-aligned in two columns, like setw(2)
+static string pad2(int n)
+{
+    return n < 10 ? " " + to_string(n) : to_string(n);
+}
+
 static bool contains(const vector<pair<int,int>> & v, int x, int y)
 {
     for (auto &p : v)
@@ -13,244 +19,448 @@ static bool contains(const vector<pair<int,int>> & v, int x, int y)
     return false;
 }
 
-void Renderer::drawBoard(const Board & b, const vector<pair<int,int>> & valid, Board::Disk turn,
-                         int cursorX, int cursorY) const
+void Renderer::drawBoard(const AnyBoard & b, const vector<pair<int,int>> & valid, Disk turn,
+                         int cursorX, int cursorY)
 {
-    clearScreen();
-    clearTerminal();
-    
+    int boardSize = b.getSize();
+    Frame& out = back;
+
+    if (lay.compact) {
+        drawCompactBoard(b, valid, cursorX, cursorY);
+        return;
+    }
+
     // Draw title
-    setTextColor(TextColor::YELLOW);
+    if (lay.title) {
+        out.moveTo(1, 1);
+        out.setColor(TextColor::YELLOW);
 
-    cout << endl << endl;
-    cout << " ██████╗ ████████╗██╗  ██╗███████╗██╗     ██╗      ██████╗ " << endl;
-    cout << "██╔═══██╗╚══██╔══╝██║  ██║██╔════╝██║     ██║     ██╔═══██╗" << endl;
-    cout << "██║   ██║   ██║   ███████║█████╗  ██║     ██║     ██║   ██║" << endl;
-    cout << "██║   ██║   ██║   ██╔══██║██╔══╝  ██║     ██║     ██║   ██║" << endl;
-    cout << "╚██████╔╝   ██║   ██║  ██║███████╗███████╗███████╗╚██████╔╝" << endl;
-    cout << " ╚═════╝    ╚═╝   ╚═╝  ╚═╝╚══════╝╚══════╝╚══════╝ ╚═════╝ " << endl;               
-                 
-    resetTextColor();
+        out << "\n\n";
+        out << " ██████╗ ████████╗██╗  ██╗███████╗██╗     ██╗      ██████╗ " << "\n";
+        out << "██╔═══██╗╚══██╔══╝██║  ██║██╔════╝██║     ██║     ██╔═══██╗" << "\n";
+        out << "██║   ██║   ██║   ███████║█████╗  ██║     ██║     ██║   ██║" << "\n";
+        out << "██║   ██║   ██║   ██╔══██║██╔══╝  ██║     ██║     ██║   ██║" << "\n";
+        out << "╚██████╔╝   ██║   ██║  ██║███████╗███████╗███████╗╚██████╔╝" << "\n";
+        out << " ╚═════╝    ╚═╝   ╚═╝  ╚═╝╚══════╝╚══════╝╚══════╝ ╚═════╝ " << "\n";
 
-    cout << endl << endl;
+        out.resetColor();
+    }
 
     // Draw board with box drawing characters
-    int boardSize = b.getSize();
-    int boardTop = 10;
-    int boardLeft = 4;
+    int boardTop = lay.boardTop;
+    int boardLeft = lay.boardLeft;
     
     // Top border
-    move_cursor(boardLeft, boardTop);
-    setTextColor(TextColor::WHITE);
-    cout << SYMBOL_DOUBLE_TOP_LEFT;
+    out.moveTo(boardLeft, boardTop);
+    out.setColor(TextColor::WHITE);
+    out << SYMBOL_DOUBLE_TOP_LEFT;
     for (int i = 0; i < boardSize; i++) {
-        cout << SYMBOL_DOUBLE_HORIZONTAL << SYMBOL_DOUBLE_HORIZONTAL << SYMBOL_DOUBLE_HORIZONTAL;
-        if (i < boardSize - 1) cout << SYMBOL_DOUBLE_T_TOP;
+        out << SYMBOL_DOUBLE_HORIZONTAL << SYMBOL_DOUBLE_HORIZONTAL << SYMBOL_DOUBLE_HORIZONTAL;
+        if (i < boardSize - 1) out << SYMBOL_DOUBLE_T_TOP;
     }
-    cout << SYMBOL_DOUBLE_TOP_RIGHT;
+    out << SYMBOL_DOUBLE_TOP_RIGHT;
 
     // Board content
     for (int y = 0; y < boardSize; y++) {
         // Content row
-        move_cursor(boardLeft, boardTop + 1 + y * 2);
-        cout << SYMBOL_DOUBLE_VERTICAL;
+        out.moveTo(boardLeft, boardTop + 1 + y * 2);
+        out << SYMBOL_DOUBLE_VERTICAL;
         for (int x = 0; x < boardSize; x++) {
             bool isCursor = x == cursorX && y == cursorY;
             bool isValidMove = contains(valid, x, y);
             
-            Board::Disk d = b.get(x, y);
+            Disk d = b.get(x, y);
             
             if (isCursor) {
-                setTextColor(TextColor::BRIGHT_WHITE);
-                cout << "[";
-                if (d == Board::Disk::X) {
-                    setTextColor(TextColor::RED);
-                    cout << BLACK_CIRCLE;
-                    resetTextColor();
+                out.setColor(TextColor::BRIGHT_WHITE);
+                out << "[";
+                if (d == Disk::X) {
+                    out.setColor(TextColor::RED);
+                    out << BLACK_CIRCLE;
+                    out.resetColor();
                 }
-                else if (d == Board::Disk::O) {
-                    setTextColor(TextColor::GREEN);
-                    cout << WHITE_CIRCLE;
-                    resetTextColor();
+                else if (d == Disk::O) {
+                    out.setColor(TextColor::GREEN);
+                    out << WHITE_CIRCLE;
+                    out.resetColor();
                 } 
                 else {
-                    cout << ' ';
+                    out << ' ';
                 }
-                cout << "]";
+                out << "]";
             } else {
-                if (d == Board::Disk::X) {
-                    cout << " " << BLACK_CIRCLE << " ";
+                if (d == Disk::X) {
+                    out << " " << BLACK_CIRCLE << " ";
                 }
-                else if (d == Board::Disk::O) {
-                    cout << " " << WHITE_CIRCLE << " ";
+                else if (d == Disk::O) {
+                    out << " " << WHITE_CIRCLE << " ";
                 }
                 else if (isValidMove) {
                     // draw possible move dot in blue
-                    setTextColor(TextColor::BRIGHT_BLUE);
-                    cout << " . ";
-                    resetTextColor();
+                    out.setColor(TextColor::BRIGHT_BLUE);
+                    out << " . ";
+                    out.resetColor();
                 }
                 else {
-                    cout << "   ";
+                    out << "   ";
                 }
             }
-            resetTextColor();
-            cout << SYMBOL_DOUBLE_VERTICAL;
+            out.resetColor();
+            out << SYMBOL_DOUBLE_VERTICAL;
         }
 
         // Separator row (except for last row)
         if (y < boardSize - 1) {
-            move_cursor(boardLeft, boardTop + 2 + y * 2);
-            cout << SYMBOL_DOUBLE_T_LEFT;
+            out.moveTo(boardLeft, boardTop + 2 + y * 2);
+            out << SYMBOL_DOUBLE_T_LEFT;
             for (int x = 0; x < boardSize; x++) {
-                cout << SYMBOL_DOUBLE_HORIZONTAL << SYMBOL_DOUBLE_HORIZONTAL << SYMBOL_DOUBLE_HORIZONTAL;
-                if (x < boardSize - 1) cout << SYMBOL_DOUBLE_INTERSECT;
+                out << SYMBOL_DOUBLE_HORIZONTAL << SYMBOL_DOUBLE_HORIZONTAL << SYMBOL_DOUBLE_HORIZONTAL;
+                if (x < boardSize - 1) out << SYMBOL_DOUBLE_INTERSECT;
             }
-            cout << SYMBOL_DOUBLE_T_RIGHT;
+            out << SYMBOL_DOUBLE_T_RIGHT;
         }
     }
 
     // Bottom border
-    move_cursor(boardLeft, boardTop + boardSize * 2);
-    cout << SYMBOL_DOUBLE_BOTTOM_LEFT;
+    out.moveTo(boardLeft, boardTop + boardSize * 2);
+    out << SYMBOL_DOUBLE_BOTTOM_LEFT;
     for (int i = 0; i < boardSize; i++) {
-        cout << SYMBOL_DOUBLE_HORIZONTAL << SYMBOL_DOUBLE_HORIZONTAL << SYMBOL_DOUBLE_HORIZONTAL;
-        if (i < boardSize - 1) cout << SYMBOL_DOUBLE_T_BOTTOM;
+        out << SYMBOL_DOUBLE_HORIZONTAL << SYMBOL_DOUBLE_HORIZONTAL << SYMBOL_DOUBLE_HORIZONTAL;
+        if (i < boardSize - 1) out << SYMBOL_DOUBLE_T_BOTTOM;
     }
-    cout << SYMBOL_DOUBLE_BOTTOM_RIGHT;
-
-    // Ensure output is flushed so the terminal receives the full board immediately
-    cout << flush;
+    out << SYMBOL_DOUBLE_BOTTOM_RIGHT;
 
     // Draw coordinates
-    setTextColor(TextColor::YELLOW);
+    out.setColor(TextColor::YELLOW);
     // Draw column coordinates (handle 1..9 and 10)
     for (int i = 0; i < boardSize; i++) {
-        move_cursor(boardLeft + 2 + i * 4, boardTop - 1);
+        out.moveTo(boardLeft + 2 + i * 4, boardTop - 1);
         if (i + 1 < 10)
-            cout << (i + 1);
+            out << (i + 1);
         else
-            cout << (i + 1); // two-digit will occupy more space but move_cursor positions are approximate
+            out << (i + 1); // two-digit will occupy more space but move_cursor positions are approximate
     }
     // Draw row coordinates
     for (int i = 0; i < boardSize; i++) {
-        move_cursor(boardLeft - 3, boardTop + 1 + i * 2);
+        out.moveTo(boardLeft - 3, boardTop + 1 + i * 2);
         if (i + 1 < 10)
-            cout << (i + 1);
+            out << (i + 1);
         else
-            cout << (i + 1);
+            out << (i + 1);
+    }
+    out.resetColor();
+}
+
+// Compact board for small terminals: one column per cell and no grid lines
+// inside the frame. The blank columns between cells hold the cursor's
+// brackets.
+void Renderer::drawCompactBoard(const AnyBoard& b, const vector<pair<int,int>>& valid,
+                                int cursorX, int cursorY)
+{
+    Frame& out = back;
+    int boardSize = b.getSize();
+
+    out.setColor(TextColor::WHITE);
+    out.moveTo(lay.boardLeft, lay.boardTop);
+    out << SYMBOL_DOUBLE_TOP_LEFT;
+    for (int i = 0; i < 2 * boardSize + 1; i++)
+        out << SYMBOL_DOUBLE_HORIZONTAL;
+    out << SYMBOL_DOUBLE_TOP_RIGHT;
+
+    for (int y = 0; y < boardSize; y++) {
+        out.moveTo(lay.boardLeft, lay.cellY(y));
+        out.setColor(TextColor::WHITE);
+        out << SYMBOL_DOUBLE_VERTICAL;
+        for (int x = 0; x <= boardSize; x++) {
+            out.setColor(TextColor::BRIGHT_WHITE);
+            if (y == cursorY && x == cursorX)
+                out << "[";
+            else if (y == cursorY && x == cursorX + 1)
+                out << "]";
+            else
+                out << " ";
+            if (x == boardSize)
+                break;
+
+            bool isCursor = x == cursorX && y == cursorY;
+            Disk d = b.get(x, y);
+            if (d == Disk::X) {
+                out.setColor(isCursor ? TextColor::RED : TextColor::DEFAULT);
+                out << BLACK_CIRCLE;
+            } else if (d == Disk::O) {
+                out.setColor(isCursor ? TextColor::GREEN : TextColor::DEFAULT);
+                out << WHITE_CIRCLE;
+            } else if (contains(valid, x, y)) {
+                out.setColor(TextColor::BRIGHT_BLUE);
+                out << ".";
+            } else {
+                out << " ";
+            }
+        }
+        out.setColor(TextColor::WHITE);
+        out << SYMBOL_DOUBLE_VERTICAL;
     }
-    resetTextColor();
+
+    out.moveTo(lay.boardLeft, lay.boardTop + lay.boardHeight - 1);
+    out << SYMBOL_DOUBLE_BOTTOM_LEFT;
+    for (int i = 0; i < 2 * boardSize + 1; i++)
+        out << SYMBOL_DOUBLE_HORIZONTAL;
+    out << SYMBOL_DOUBLE_BOTTOM_RIGHT;
+
+    // Coordinates: only the last digit of the column fits over a cell
+    out.setColor(TextColor::YELLOW);
+    for (int i = 0; i < boardSize; i++) {
+        out.moveTo(lay.cellX(i) + 1, lay.boardTop - 1);
+        out << (i + 1) % 10;
+        out.moveTo(lay.boardLeft - 3, lay.cellY(i));
+        out << (i + 1);
+    }
+    out.resetColor();
+}
+
+void Renderer::resize()
+{
+    int cols = 0, rows = 0;
+    if (!get_terminal_size(cols, rows)) {
+        cols = 120;
+        rows = 40;
+    }
+    if (cols == termCols && rows == termRows)
+        return; // a SIGWINCH that changed nothing (or one already handled)
+    termCols = cols;
+    termRows = rows;
+    lay.cols = 0; // recomputed by the next frame, which is sent whole
+    repaint = true;
+}
+
+void Renderer::updateLayout(int boardSize)
+{
+    // back was the previous front, which may still have the old size
+    if (back.width() != termCols || back.height() != termRows)
+        back.resize(termCols, termRows);
+    if (lay.cols == termCols && lay.rows == termRows && lay.boardSize == boardSize)
+        return;
+    lay = Layout::compute(termCols, termRows, boardSize);
+    repaint = true;
+}
+
+unsigned Renderer::beginFrame(int boardSize, unsigned regions)
+{
+    updateLayout(boardSize);
+    if (repaint || regions == ALL || front.width() != back.width() || front.height() != back.height()) {
+        // A new frame: start from blank cells rather than clearing the terminal
+        back.clear();
+        return ALL;
+    }
+
+    // Start from what the terminal shows and blank the regions to redraw
+    back.copyCells(front);
+    int menuX = lay.menuX, menuY = lay.menuY;
+    if (regions & BOARD)
+        back.clear(1, lay.boardTop - 1, lay.boardLeft + lay.boardWidth - 1, lay.boardHeight + 1);
+    if (regions & (SCORE | CLOCK))
+        back.clear(menuX, menuY, Layout::PANEL_WIDTH, 3);
+    if (regions & STATUS)
+        back.clear(menuX, menuY + 4, Layout::PANEL_WIDTH, 3);
+    if (regions & HISTORY) {
+        back.clear(menuX, menuY + 7, Layout::PANEL_WIDTH, lay.historyRows + 3);
+        if (lay.database)
+            back.clear(lay.databaseX, menuY + 7, Layout::DATABASE_WIDTH, lay.historyRows + 3);
+    }
+    return regions;
 }
 
 void Renderer::drawSideMenu(const vector<MoveRecord>& history, int scoreX, int scoreO, 
-                           Board::Disk currentTurn, int cursorX, int cursorY, int elapsedSeconds, int boardSize) const
+                           Disk currentTurn, int cursorX, int cursorY, int elapsedSeconds, int boardSize,
+                           const string& status, unsigned regions)
 {
-    int menuY = 10;
-
-    // Calculate board width in characters: each cell is 3 chars plus vertical lines
-    int boardCharWidth = boardSize * 4 + 1; // approximate
-
-    // Try to place menu to the right of the board; if terminal is small or board is large,
-    // push menu further right or to the far right edge
-    int termCols = 0, termRows = 0;
-    if (!get_terminal_size(termCols, termRows)) termCols = 120; // fallback
-
-    int boardLeft = 4;
-    int proposedMenuX = boardLeft + boardCharWidth + 4;
-    int menuX = proposedMenuX;
-    if (menuX + 40 > termCols) {
-        // shift menu to fit within terminal
-        menuX = max(boardLeft + boardCharWidth + 2, termCols - 48);
-        if (menuX < boardLeft + boardCharWidth + 1) menuX = boardLeft + boardCharWidth + 1;
+    updateLayout(boardSize);
+    int menuX = lay.menuX;
+    int menuY = lay.menuY;
+
+    Frame& out = back;
+
+    if (regions & (SCORE | CLOCK)) {
+        // Draw score and timer
+        out.moveTo(menuX, menuY);
+        out.setColor(TextColor::WHITE);
+        out << "╔═══════╦════╦═════╦═════╦════╦═══════╗";
+        out.moveTo(menuX, menuY + 1);
+        out << "║ " << formatTime(elapsedSeconds) << " ║ " << pad2(scoreX) << " ║  " << BLACK_CIRCLE << "  ║  " << WHITE_CIRCLE << "  ║ " << pad2(scoreO) << " ║ " << formatTime(elapsedSeconds) << " ║";
+        out.moveTo(menuX, menuY + 2);
+        out << "╚═══════╩════╩═════╩═════╩════╩═══════╝";
     }
     
-    // Draw score and timer
-    move_cursor(menuX, menuY);
-    setTextColor(TextColor::WHITE);
-    cout << "╔═══════╦════╦═════╦═════╦════╦═══════╗";
-    move_cursor(menuX, menuY + 1);
-    cout << "║ " << formatTime(elapsedSeconds) << " ║ " << setw(2) << scoreX << " ║  " << BLACK_CIRCLE << "  ║  " << WHITE_CIRCLE << "  ║ " << setw(2) << scoreO << " ║ " << formatTime(elapsedSeconds) << " ║";
-    move_cursor(menuX, menuY + 2);
-    cout << "╚═══════╩════╩═════╩═════╩════╩═══════╝";
-    
-    // Draw current turn indicator
-    move_cursor(menuX, menuY + 4);
-    setTextColor(TextColor::BRIGHT_WHITE);
-    cout << "Current turn: ";
-    if (currentTurn == Board::Disk::X) {
-        cout << BLACK_CIRCLE;
-    } else {
-        cout << WHITE_CIRCLE;
+    if (regions & STATUS) {
+        // Draw current turn indicator
+        out.moveTo(menuX, menuY + 4);
+        out.setColor(TextColor::BRIGHT_WHITE);
+        out << "Current turn: ";
+        if (currentTurn == Disk::X) {
+            out << BLACK_CIRCLE;
+        } else {
+            out << WHITE_CIRCLE;
+        }
+
+        // Draw cursor position
+        out.moveTo(menuX, menuY + 5);
+        out.resetColor();
+        out << "Cursor: " << (char)('A' + cursorX) << (cursorY + 1);
+
+        // Engine / status line
+        out.moveTo(menuX, menuY + 6);
+        out.field(status, 39);
     }
     
-    // Draw cursor position
-    move_cursor(menuX, menuY + 5);
-    resetTextColor();
-    cout << "Cursor: " << (char)('A' + cursorX) << (cursorY + 1);
-    
     // Draw move history
-    drawMoveHistory(history, menuX, menuY + 7, 0);
+    if (regions & HISTORY)
+        drawMoveHistory(history, menuX, menuY + 7, 0);
     
     // Draw instructions
-    drawInstructions(menuX, menuY + 20);
+    if (regions & STATIC)
+        drawInstructions(menuX, lay.instructionsY);
 }
 
-void Renderer::drawInstructions(int x, int y) const
+void Renderer::drawInstructions(int x, int y)
 {
-    move_cursor(x, y);
-    setTextColor(TextColor::WHITE);
-    cout << "╔═════════════════════════════════════╗";
-    move_cursor(x, y + 1);
-    cout << "║ ↑←↓→  : Move cursor    ENTER : Place║";
-    move_cursor(x, y + 2);
-    cout << "║ WASD  : Move cursor    R     : Reset║";
-    move_cursor(x, y + 3);
-    cout << "║ Q     : Quit game      ESC   : Quit ║";
-    move_cursor(x, y + 4);
-    cout << "╚═════════════════════════════════════╝";
-    resetTextColor();
+    Frame& out = back;
+    out.moveTo(x, y);
+    out.setColor(TextColor::WHITE);
+    out << "╔═════════════════════════════════════╗";
+    out.moveTo(x, y + 1);
+    out << "║ ↑←↓→  : Move cursor    ENTER : Place║";
+    out.moveTo(x, y + 2);
+    out << "║ WASD  : Move cursor    R     : Reset║";
+    out.moveTo(x, y + 3);
+    out << "║ U     : Undo move      [ ]   :Scroll║";
+    out.moveTo(x, y + 4);
+    out << "║ Q     : Quit game      ESC   : Quit ║";
+    out.moveTo(x, y + 5);
+    out << "╚═════════════════════════════════════╝";
+    out.resetColor();
 }
 
-void Renderer::drawMoveHistory(const vector<MoveRecord>& history, int x, int y, int scrollOffset) const
+void Renderer::drawMoveHistory(const vector<MoveRecord>& history, int x, int y, int scrollOffset)
 {
-    move_cursor(x, y);
-    setTextColor(TextColor::WHITE);
-    cout << "              Historical moves";
-    move_cursor(x, y + 1);
-    cout << "╔─────────────────────────────────────╗";
+    Frame& out = back;
+    out.moveTo(x, y);
+    out.setColor(TextColor::WHITE);
+    out << "              Historical moves";
+    out.moveTo(x, y + 1);
+    out << "╔─────────────────────────────────────╗";
     
-    int maxMoves = 10;
+    int maxMoves = lay.historyRows;
     int startIdx = max(0, (int)history.size() - maxMoves - scrollOffset);
     int endIdx = min((int)history.size(), startIdx + maxMoves);
     
     for (int i = startIdx; i < endIdx; i++) {
-        move_cursor(x, y + 2 + (i - startIdx));
-        cout << "║ " << setw(2) << (i + 1) << ". ";
+        out.moveTo(x, y + 2 + (i - startIdx));
+        out << "║ " << pad2(i + 1) << ". ";
         
-        if (history[i].player == Board::Disk::X) {
-            cout << BLACK_CIRCLE;
+        if (history[i].player == Disk::X) {
+            out << BLACK_CIRCLE;
         } else {
-            cout << WHITE_CIRCLE;
+            out << WHITE_CIRCLE;
         }
-        resetTextColor();
-        cout << " (" << (char)('A' + history[i].col) << (history[i].row + 1) << ")";
+        out.resetColor();
+        out << " (" << (char)('A' + history[i].col) << (history[i].row + 1) << ")";
         
         // Fill remaining space
         int remaining = 35 - (4 + 1 + 4); // 4 for number, 1 for player, 4 for position
-        for (int j = 0; j < remaining; j++) cout << " ";
-        cout << "║";
+        for (int j = 0; j < remaining; j++) out << " ";
+        out << "║";
     }
     
     // Fill empty lines if needed
     for (int i = endIdx - startIdx; i < maxMoves; i++) {
-        move_cursor(x, y + 2 + i);
-        cout << "║                                     ║";
+        out.moveTo(x, y + 2 + i);
+        out << "║                                     ║";
     }
     
-    move_cursor(x, y + 2 + maxMoves);
-    cout << "╚─────────────────────────────────────╝";
-    resetTextColor();
+    out.moveTo(x, y + 2 + maxMoves);
+    out << "╚─────────────────────────────────────╝";
+    out.resetColor();
 }
 
 
+void Renderer::drawDatabase(const vector<MoveStats>& moves)
+{
+    if (!lay.database)
+        return;
+    Frame& out = back;
+    int x = lay.databaseX, y = lay.menuY + 7;
+    out.moveTo(x, y);
+    out.setColor(TextColor::WHITE);
+    out << "       Database";
+    out.moveTo(x, y + 1);
+    out << "╔─────────────────────╗";
+    for (int i = 0; i < lay.historyRows; i++) {
+        out.moveTo(x, y + 2 + i);
+        char line[32] = "";
+        if (i < (int)moves.size()) {
+            const MoveStats& m = moves[i];
+            snprintf(line, sizeof line, "%c%-2d %8u %5.1f%%", 'A' + m.x, m.y + 1, m.games, 100 * m.score);
+        } else if (i == 0) {
+            snprintf(line, sizeof line, "no games here");
+        }
+        out << "║ ";
+        out.field(line, Layout::DATABASE_WIDTH - 4);
+        out << " ║";
+    }
+    out.moveTo(x, y + 2 + lay.historyRows);
+    out << "╚─────────────────────╝";
+    out.resetColor();
+}
+
+void Renderer::drawText(int x, int y, const string& text, TextColor color)
+{
+    back.moveTo(x, y);
+    back.setColor(color);
+    back << text;
+    back.resetColor();
+}
+
+void Renderer::present()
+{
+    // After a resize (or on the first frame) the terminal content is unknown:
+    // clear it once and send every cell. Otherwise only the differences.
+    bool full = repaint || front.width() != back.width() || front.height() != back.height();
+    if (full) {
+        output.forget();
+        output.clearScreen();
+    }
+
+    for (int y = 0; y < back.height(); y++) {
+        for (int x = 0; x < back.width(); x++) {
+            const Cell& c = back.at(x, y);
+            if (full ? c == Cell() : c == front.at(x, y))
+                continue;
+            // A short run of unchanged cells in the current colour is cheaper
+            // to print again than to jump over
+            int fromX = output.cursorX() - 1;
+            if (!full && output.cursorY() == y + 1 && fromX >= 0 && fromX < x) {
+                int cost = output.moveCost(x + 1, y + 1), bytes = 0;
+                for (int i = fromX; i < x && bytes < cost; i++) {
+                    const Cell& skipped = back.at(i, y);
+                    char glyph[4];
+                    bytes = skipped.color == output.color() ? bytes + encodeUtf8(skipped.ch, glyph) : cost;
+                }
+                if (bytes < cost)
+                    for (int i = fromX; i < x; i++)
+                        output.glyph(back.at(i, y).ch);
+            }
+            output.moveTo(x + 1, y + 1);
+            output.setColor(c.color);
+            output.glyph(c.ch);
+        }
+    }
+
+    size_t bytes = output.flush();
+    stats.frames++;
+    stats.bytes += bytes;
+    stats.lastBytes = bytes;
+    stats.maxBytes = max(stats.maxBytes, bytes);
+
+    swap(front, back);
+    repaint = false;
+}
@@ -0,0 +1,107 @@
+#include "self_play.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+Player::Player(const PlayerConfig& config) : settings(config)
+{
+    if (settings.random)
+        return;
+    engine = make_unique<Engine>(settings.hashMB, settings.threads);
+    engine->setEvaluator(settings.eval);
+    engine->setAlgorithm(settings.algorithm);
+}
+
+void Player::newGame()
+{
+    if (engine)
+        engine->newGame();
+}
+
+int Player::chooseMove(const AnyBoard& board, Disk side, Xoshiro256& rng, const SearchLimits* limits)
+{
+    if (!engine) {
+        const auto& moves = board.getValid(side);
+        auto [x, y] = moves[rng.below((uint32_t)moves.size())];
+        last = SearchResult();
+        return y * board.getSize() + x;
+    }
+    last = engine->think(board, side, limits ? *limits : settings.limits);
+    return last.move;
+}
+
+Disk playGame(AnyBoard& board, Player& x, Player& o, const vector<uint8_t>& opening,
+              int randomPlies, Xoshiro256& rng, GameRecord& game, const TimeControl* clock)
+{
+    using Clock = chrono::steady_clock;
+    int n = board.getSize();
+    board.reset();
+    x.newGame();
+    o.newGame();
+    game.boardSize = n;
+    game.players = 3;
+    game.moves.clear();
+    game.status = GameRecord::PLAYING;
+    Clock::duration used[2] = {};
+    double remaining[2] = { clock ? clock->base : 0, clock ? clock->base : 0 };
+    Disk flagged = Disk::Empty;
+
+    Disk side = Disk::X;
+    size_t book = 0;
+    int randomLeft = randomPlies;
+    while (true) {
+        if (board.getValid(side).empty()) {
+            if (board.getValid(opponent(side)).empty())
+                break;
+            game.moves.push_back(record::PASS);
+            side = opponent(side);
+        }
+
+        int sq = -1;
+        if (book < opening.size()) {
+            sq = opening[book++];
+            if (!board.isValid(sq % n, sq / n, side)) {
+                book = opening.size();  // not a legal line: play on from here
+                sq = -1;
+            }
+        }
+        if (sq < 0 && randomLeft > 0) {
+            const auto& moves = board.getValid(side);
+            auto [mx, my] = moves[rng.below((uint32_t)moves.size())];
+            sq = my * n + mx;
+            randomLeft--;
+        }
+        if (sq < 0) {
+            Player& mover = side == Disk::X ? x : o;
+            int s = side == Disk::X ? 0 : 1;
+            SearchLimits limits = mover.config().limits;
+            if (clock)
+                limits.seconds = moveBudget(remaining[s], clock->increment, board.count(Disk::Empty));
+            auto start = Clock::now();
+            sq = mover.chooseMove(board, side, rng, &limits);
+            Clock::duration took = Clock::now() - start;
+            used[s] += took;
+            if (clock) {
+                remaining[s] -= chrono::duration<double>(took).count();
+                if (remaining[s] < 0) {
+                    flagged = side;
+                    break;
+                }
+                remaining[s] += clock->increment;
+            }
+        }
+
+        board.put(sq % n, sq / n, side);
+        game.moves.push_back((uint8_t)sq);
+        side = opponent(side);
+    }
+
+    game.status = flagged == Disk::Empty ? GameRecord::FINISHED : GameRecord::ABANDONED;
+    for (int i = 0; i < 2; i++)
+        game.clockMs[i] = (uint32_t)chrono::duration_cast<chrono::milliseconds>(used[i]).count();
+    game.discs[0] = board.count(Disk::X);
+    game.discs[1] = board.count(Disk::O);
+    return flagged;
+}
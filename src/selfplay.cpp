@@ -0,0 +1,190 @@
+// selfplay: plays games between computer players on every core, headless, and
+// appends them to a game log (game_record.hpp), e.g. as training data or as
+// an overnight regression run of the engine.
+//
+//   selfplay [--games G] [--threads T] [--size 8|10|12] [--out FILE]
+//            [--x engine|random] [--o engine|random] [--random-plies K]
+//            [--depth D] [--time SECONDS] [--exact EMPTIES] [--hash MB]
+//            [--eval square|pattern|nnue] [--engine alphabeta|mcts] [--seed S]
+//
+// Every worker thread owns its board, game record and players (each with its
+// engine and transposition table) and takes the next game from a shared
+// counter; the log is the only thing they share, once per finished game.
+// Game g starts with K random moves drawn from seed + g, so a run plays the
+// same openings whatever the number of threads. --threads 0 (the default)
+// uses every core.
+
+#include "game_record.hpp"
+#include "self_play.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+struct Options {
+    uint64_t games = 100;
+    int threads = 0;
+    int size = 8;
+    int randomPlies = 8;
+    uint64_t seed = 1;
+    string out;
+    PlayerConfig players[2];
+};
+
+struct Totals {
+    atomic<uint64_t> games{ 0 };
+    atomic<uint64_t> positions{ 0 };
+    atomic<uint64_t> wins[2] = { { 0 }, { 0 } };    // X, O
+    atomic<uint64_t> draws{ 0 };
+};
+
+static void usage()
+{
+    cerr << "usage: selfplay [--games G] [--threads T] [--size 8|10|12] [--out FILE]\n"
+            "                [--x engine|random] [--o engine|random] [--random-plies K]\n"
+            "                [--depth D] [--time SECONDS] [--exact EMPTIES] [--hash MB]\n"
+            "                [--eval square|pattern|nnue] [--engine alphabeta|mcts] [--seed S]" << endl;
+}
+
+static bool parse(int argc, char** argv, Options& opt)
+{
+    PlayerConfig engine;
+    engine.limits.maxDepth = 4;
+    engine.limits.seconds = 1e9;    // the depth is the limit unless --time is given
+    engine.limits.exactEmpties = 12;
+    bool random[2] = { false, false };
+
+    for (int i = 1; i < argc; i++) {
+        string a = argv[i];
+        bool value = i + 1 < argc;
+        if (a == "--games" && value) opt.games = strtoull(argv[++i], nullptr, 10);
+        else if (a == "--threads" && value) opt.threads = atoi(argv[++i]);
+        else if (a == "--size" && value) opt.size = atoi(argv[++i]);
+        else if (a == "--out" && value) opt.out = argv[++i];
+        else if ((a == "--x" || a == "--o") && value) {
+            string kind = argv[++i];
+            if (kind != "engine" && kind != "random")
+                return false;
+            random[a == "--x" ? 0 : 1] = kind == "random";
+        }
+        else if (a == "--random-plies" && value) opt.randomPlies = max(0, atoi(argv[++i]));
+        else if (a == "--depth" && value) engine.limits.maxDepth = max(1, atoi(argv[++i]));
+        else if (a == "--time" && value) {
+            engine.limits.seconds = atof(argv[++i]);
+            engine.limits.maxDepth = 64;
+        }
+        else if (a == "--exact" && value) engine.limits.exactEmpties = max(0, atoi(argv[++i]));
+        else if (a == "--hash" && value) engine.hashMB = max(1, atoi(argv[++i]));
+        else if (a == "--eval" && value) {
+            string e = argv[++i];
+            if (e == "square") engine.eval = EvalKind::SQUARES;
+            else if (e == "pattern") engine.eval = EvalKind::PATTERNS;
+            else if (e == "nnue") engine.eval = EvalKind::NNUE;
+            else return false;
+        }
+        else if (a == "--engine" && value) {
+            string e = argv[++i];
+            if (e == "alphabeta") engine.algorithm = Algorithm::ALPHA_BETA;
+            else if (e == "mcts") engine.algorithm = Algorithm::MCTS;
+            else return false;
+        }
+        else if (a == "--seed" && value) opt.seed = strtoull(argv[++i], nullptr, 10);
+        else return false;
+    }
+    if (opt.size != 8 && opt.size != 10 && opt.size != 12)
+        return false;
+    if (opt.threads <= 0)
+        opt.threads = max(1u, thread::hardware_concurrency());
+    for (int s = 0; s < 2; s++) {
+        opt.players[s] = engine;
+        opt.players[s].random = random[s];
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if (!parse(argc, argv, opt)) {
+        usage();
+        return 2;
+    }
+
+    GameLog log;
+    string error;
+    if (!opt.out.empty()) {
+        if (!log.open(opt.out, &error)) {
+            cerr << error << endl;
+            return 1;
+        }
+        log.setBatch(1 << 16, 1.0);
+    }
+    mutex logLock;
+
+    Totals totals;
+    atomic<uint64_t> nextGame{ 0 };
+    mutex doneLock;
+    condition_variable doneSignal;
+    int running = opt.threads;
+
+    auto work = [&] {
+        AnyBoard board(opt.size);
+        GameRecord game;
+        game.moves.reserve(2 * opt.size * opt.size);
+        Player x(opt.players[0]), o(opt.players[1]);
+        Xoshiro256 rng;
+        const vector<uint8_t> noOpening;
+        for (uint64_t g; (g = nextGame++) < opt.games; ) {
+            rng.reseed(opt.seed + g);
+            playGame(board, x, o, noOpening, opt.randomPlies, rng, game);
+            if (log.isOpen()) {
+                lock_guard<mutex> hold(logLock);
+                log.appendGame(game);
+            }
+            totals.positions += game.discs[0] + game.discs[1] - 4;
+            if (game.discs[0] == game.discs[1])
+                totals.draws++;
+            else
+                totals.wins[game.discs[0] > game.discs[1] ? 0 : 1]++;
+            totals.games++;
+        }
+        lock_guard<mutex> hold(doneLock);
+        if (--running == 0)
+            doneSignal.notify_one();
+    };
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (int t = 0; t < opt.threads; t++)
+        pool.emplace_back(work);
+    {
+        unique_lock<mutex> wait(doneLock);
+        while (!doneSignal.wait_for(wait, chrono::seconds(1), [&] { return running == 0; })) {
+            double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cerr << "\r" << totals.games << "/" << opt.games << " games, "
+                 << fixed << setprecision(1) << totals.games / secs << " games/s" << flush;
+        }
+    }
+    for (thread& t : pool)
+        t.join();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (secs >= 1)
+        cerr << endl;
+    log.close();
+
+    cout << "selfplay: " << totals.games << " games on " << opt.threads << " threads, "
+         << fixed << setprecision(2) << secs << " s" << endl;
+    cout << "  games     " << setprecision(1) << totals.games / secs << "/s" << endl;
+    cout << "  positions " << setprecision(0) << totals.positions / secs << "/s" << endl;
+    cout << "  X wins " << totals.wins[0] << ", O wins " << totals.wins[1] << ", draws " << totals.draws << endl;
+    return 0;
+}
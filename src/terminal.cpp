@@ -0,0 +1,208 @@
+#include "terminal.hpp"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+using namespace std;
+
+// The settings to put back when a signal ends the game; the handler can only
+// reach them through globals
+static termios signalSaved;
+static volatile sig_atomic_t signalRestore = 0;
+static const int EXIT_SIGNALS[] = { SIGINT, SIGTERM, SIGHUP };
+
+static void onExitSignal(int sig)
+{
+    if (signalRestore)
+        tcsetattr(STDIN_FILENO, TCSANOW, &signalSaved);
+    // Plain colours and the cursor back, as Game::run leaves them
+    static const char reset[] = "\033[0m\033[?25h";
+    (void)!write(STDOUT_FILENO, reset, sizeof reset - 1);
+    // Then die of the signal as if there were no handler
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+TerminalSession::TerminalSession()
+{
+    if (tcgetattr(STDIN_FILENO, &saved) != 0)
+        return; // not a terminal: nothing to set or restore
+    termios raw = saved;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    active = tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0;
+    if (!active)
+        return;
+
+    // Ctrl-C, kill or a closed terminal skip the destructor: restore the
+    // shell's settings from the handler instead
+    signalSaved = saved;
+    signalRestore = 1;
+    struct sigaction sa = {};
+    sa.sa_handler = onExitSignal;
+    sigemptyset(&sa.sa_mask);
+    for (int i = 0; i < 3; i++)
+        sigaction(EXIT_SIGNALS[i], &sa, &previous[i]);
+}
+
+TerminalSession::~TerminalSession()
+{
+    if (!active)
+        return;
+    for (int i = 0; i < 3; i++)
+        sigaction(EXIT_SIGNALS[i], &previous[i], nullptr);
+    signalRestore = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+}
+
+// Write end of the SIGWINCH self-pipe; the handler can only reach it through
+// a global
+static volatile sig_atomic_t resizeWriteFd = -1;
+
+static void onResize(int)
+{
+    int saved = errno;
+    char byte = 0;
+    if (resizeWriteFd >= 0)
+        (void)!write(resizeWriteFd, &byte, 1); // full pipe: a resize is already pending
+    errno = saved;
+}
+
+EventLoop::EventLoop()
+{
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    int fds[2];
+    if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) == 0) {
+        resizeFd = fds[0];
+        resizeWriteFd = fds[1];
+        struct sigaction sa = {};
+        sa.sa_handler = onResize;
+        sa.sa_flags = SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGWINCH, &sa, nullptr);
+    }
+}
+
+EventLoop::~EventLoop()
+{
+    if (timerFd >= 0)
+        close(timerFd);
+    if (resizeFd >= 0) {
+        signal(SIGWINCH, SIG_DFL);
+        close(resizeWriteFd);
+        resizeWriteFd = -1;
+        close(resizeFd);
+    }
+}
+
+void EventLoop::startClock(chrono::steady_clock::time_point origin)
+{
+    if (timerFd < 0)
+        return;
+    // steady_clock is CLOCK_MONOTONIC, so the first tick can be given as an
+    // absolute time and every later one lands on a whole second of the clock
+    auto first = chrono::duration_cast<chrono::nanoseconds>((origin + chrono::seconds(1)).time_since_epoch()).count();
+    itimerspec spec = {};
+    spec.it_interval.tv_sec = 1;
+    spec.it_value.tv_sec = first / 1000000000;
+    spec.it_value.tv_nsec = first % 1000000000;
+    timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+unsigned EventLoop::wait(vector<Key>& keys, int timeoutMs)
+{
+    if (!queued.empty() || deferred) {
+        unsigned events = deferred;
+        deferred = 0;
+        if (!queued.empty())
+            events |= KEYS;
+        keys.insert(keys.end(), queued.begin(), queued.end());
+        queued.clear();
+        return events;
+    }
+
+    pollfd fds[4];
+    int count = 0;
+    fds[count++] = { STDIN_FILENO, POLLIN, 0 };
+    if (timerFd >= 0)
+        fds[count++] = { timerFd, POLLIN, 0 };
+    if (engineFd >= 0)
+        fds[count++] = { engineFd, POLLIN, 0 };
+    if (resizeFd >= 0)
+        fds[count++] = { resizeFd, POLLIN, 0 };
+
+    size_t before = keys.size();
+    while (true) {
+        int timeout = timeoutMs;
+        if (decoder.pending() && (timeout < 0 || timeout > KeyDecoder::ESC_TIMEOUT_MS))
+            timeout = KeyDecoder::ESC_TIMEOUT_MS;
+        int ready = poll(fds, count, timeout);
+        if (ready < 0) {
+            if (errno == EINTR)
+                continue;
+            return 0;
+        }
+        if (ready == 0) {
+            if (!decoder.pending())
+                return 0;
+            decoder.timeout(keys);
+            if (keys.size() > before)
+                return KEYS;
+            continue;
+        }
+
+        unsigned events = 0;
+        for (int i = 0; i < count; i++) {
+            if (!fds[i].revents)
+                continue;
+            if (fds[i].fd == STDIN_FILENO) {
+                char buf[256];
+                ssize_t n = read(STDIN_FILENO, buf, sizeof buf);
+                if (n > 0) {
+                    decoder.feed(buf, (size_t)n, keys);
+                } else if (n == 0 || (errno != EINTR && errno != EAGAIN)
+                           || (fds[i].revents & (POLLHUP | POLLERR))) {
+                    // Input closed or gone (EIO after a hangup): leave the
+                    // game rather than poll a dead descriptor forever
+                    keys.push_back({ InputKey::ESC, 0 });
+                }
+            } else if (fds[i].fd == resizeFd) {
+                // Any number of signals since the last look make one resize
+                char buf[64];
+                while (read(resizeFd, buf, sizeof buf) > 0) {}
+                events |= RESIZE;
+            } else {
+                // timerfd: expirations since the last read; eventfd: signals
+                uint64_t value;
+                if (read(fds[i].fd, &value, sizeof value) == (ssize_t)sizeof value)
+                    events |= fds[i].fd == timerFd ? TICK : ENGINE;
+            }
+        }
+        if (keys.size() > before)
+            events |= KEYS;
+        if (events)
+            return events;
+        // Only part of an escape sequence so far: keep waiting for the rest
+    }
+}
+
+Key EventLoop::waitKey()
+{
+    while (true) {
+        vector<Key> keys;
+        unsigned events = wait(keys);
+        deferred |= events & RESIZE;    // for the next wait() after the menu
+        if (!(events & KEYS))
+            continue;
+        queued.assign(keys.begin() + 1, keys.end());
+        return keys.front();
+    }
+}
@@ -0,0 +1,403 @@
+// tournament: engine configurations against each other, headless, to check
+// that a change does not cost playing strength.
+//
+//   tournament --engine SPEC --engine SPEC [--engine SPEC ...]
+//              [--games G] [--size 8|10|12] [--tc BASE[+INC]] [--concurrency C]
+//              [--openings FILE | --random-plies K] [--seed S]
+//              [--sprt ELO0 ELO1] [--alpha A] [--beta B] [--out FILE]
+//
+// SPEC is a comma-separated list of key=value: name, depth, time (seconds per
+// move), eval (square|pattern|nnue), engine (alphabeta|mcts), threads, hash
+// (MB), exact (empties), or just "random". Every two engines meet in pairs of
+// games with the same opening and the colours swapped. Openings are lines of
+// moves from FILE (e.g. f5d6c3, one per line) or K random moves (default 6).
+//
+// --tc gives each side a clock of BASE seconds plus INC per move; a side that
+// oversteps it loses. Games run side by side, but never more than the cores
+// can serve: a game needs as many cores as its engines' threads, so by
+// default C is the number of cores divided by that. --sprt stops a match of
+// two engines as soon as it is decided (alpha and beta default to 0.05).
+//
+//   tournament --verify
+//
+// checks the Elo, error margin and SPRT arithmetic against values worked out
+// with fishtest's formulas (stat_util: stats, LLR_logistic, regularize).
+
+#include "elo.hpp"
+#include "game_record.hpp"
+#include "notation.hpp"
+#include "self_play.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+struct EngineSpec {
+    string name;
+    PlayerConfig config;
+};
+
+// Results of engine `a` against engine `b`, from a's point of view
+struct Pairing {
+    int a, b;
+    elo::Pentanomial pairs;
+    uint64_t wins = 0, draws = 0, losses = 0;
+    uint64_t timeLosses[2] = { 0, 0 };  // a, b
+};
+
+struct Options {
+    vector<EngineSpec> engines;
+    uint64_t games = 200;
+    int size = 8;
+    TimeControl clock;
+    bool timed = false;
+    int concurrency = 0;
+    string openingsFile;
+    int randomPlies = 6;
+    uint64_t seed = 1;
+    bool sprt = false;
+    elo::Sprt test;
+    string out;
+};
+
+static void usage()
+{
+    cerr << "usage: tournament --engine SPEC --engine SPEC [--engine SPEC ...]\n"
+            "                  [--games G] [--size 8|10|12] [--tc BASE[+INC]] [--concurrency C]\n"
+            "                  [--openings FILE | --random-plies K] [--seed S]\n"
+            "                  [--sprt ELO0 ELO1] [--alpha A] [--beta B] [--out FILE]\n"
+            "       SPEC: name=N,depth=D,time=S,eval=square|pattern|nnue,engine=alphabeta|mcts,\n"
+            "             threads=T,hash=MB,exact=E, or random\n"
+            "       tournament --verify" << endl;
+}
+
+static bool parseEngine(const string& spec, EngineSpec& e, int index)
+{
+    e.name = "engine" + to_string(index + 1);
+    e.config.limits.seconds = 0.1;
+    bool timeGiven = false, depthGiven = false;
+    stringstream in(spec);
+    string item;
+    while (getline(in, item, ',')) {
+        size_t eq = item.find('=');
+        string key = item.substr(0, eq), value = eq == string::npos ? "" : item.substr(eq + 1);
+        if (key == "random" && eq == string::npos) {
+            e.config.random = true;
+            if (e.name.rfind("engine", 0) == 0)
+                e.name = "random";
+        }
+        else if (eq == string::npos) return false;
+        else if (key == "name") e.name = value;
+        else if (key == "depth") {
+            e.config.limits.maxDepth = max(1, atoi(value.c_str()));
+            depthGiven = true;
+        }
+        else if (key == "time") {
+            e.config.limits.seconds = atof(value.c_str());
+            timeGiven = true;
+        }
+        else if (key == "threads") e.config.threads = max(1, atoi(value.c_str()));
+        else if (key == "hash") e.config.hashMB = max(1, atoi(value.c_str()));
+        else if (key == "exact") e.config.limits.exactEmpties = max(0, atoi(value.c_str()));
+        else if (key == "eval") {
+            if (value == "square") e.config.eval = EvalKind::SQUARES;
+            else if (value == "pattern") e.config.eval = EvalKind::PATTERNS;
+            else if (value == "nnue") e.config.eval = EvalKind::NNUE;
+            else return false;
+        }
+        else if (key == "engine") {
+            if (value == "alphabeta") e.config.algorithm = Algorithm::ALPHA_BETA;
+            else if (value == "mcts") e.config.algorithm = Algorithm::MCTS;
+            else return false;
+        }
+        else return false;
+    }
+    if (depthGiven && !timeGiven)
+        e.config.limits.seconds = 1e9;  // the depth is the limit
+    return true;
+}
+
+static bool parse(int argc, char** argv, Options& opt)
+{
+    for (int i = 1; i < argc; i++) {
+        string a = argv[i];
+        bool value = i + 1 < argc;
+        if (a == "--engine" && value) {
+            EngineSpec e;
+            if (!parseEngine(argv[++i], e, (int)opt.engines.size()))
+                return false;
+            opt.engines.push_back(e);
+        }
+        else if (a == "--games" && value) opt.games = strtoull(argv[++i], nullptr, 10);
+        else if (a == "--size" && value) opt.size = atoi(argv[++i]);
+        else if (a == "--tc" && value) {
+            string tc = argv[++i];
+            size_t plus = tc.find('+');
+            opt.clock.base = atof(tc.substr(0, plus).c_str());
+            opt.clock.increment = plus == string::npos ? 0 : atof(tc.substr(plus + 1).c_str());
+            opt.timed = opt.clock.base > 0;
+        }
+        else if (a == "--concurrency" && value) opt.concurrency = atoi(argv[++i]);
+        else if (a == "--openings" && value) opt.openingsFile = argv[++i];
+        else if (a == "--random-plies" && value) opt.randomPlies = max(0, atoi(argv[++i]));
+        else if (a == "--seed" && value) opt.seed = strtoull(argv[++i], nullptr, 10);
+        else if (a == "--sprt" && i + 2 < argc) {
+            opt.sprt = true;
+            opt.test.elo0 = atof(argv[++i]);
+            opt.test.elo1 = atof(argv[++i]);
+        }
+        else if (a == "--alpha" && value) opt.test.alpha = atof(argv[++i]);
+        else if (a == "--beta" && value) opt.test.beta = atof(argv[++i]);
+        else if (a == "--out" && value) opt.out = argv[++i];
+        else return false;
+    }
+    return opt.engines.size() >= 2 && (opt.size == 8 || opt.size == 10 || opt.size == 12) &&
+           (!opt.sprt || opt.engines.size() == 2);
+}
+
+// One opening per line, as moves like f5d6c3 (blank lines are skipped). A
+// line that does not parse or play through is an error, with its number in
+// `error`, rather than an opening quietly cut short.
+static bool loadOpenings(const string& path, int size, vector<vector<uint8_t>>& openings, string& error)
+{
+    ifstream in(path);
+    if (!in) {
+        error = path + ": cannot open";
+        return false;
+    }
+    AnyBoard board(size);
+    string line;
+    for (int number = 1; getline(in, line); number++) {
+        string why;
+        Disk side;
+        board.reset();
+        if (!playMoves(board, line, side, &why)) {
+            error = path + ":" + to_string(number) + ": " + why;
+            return false;
+        }
+        vector<uint8_t> moves;
+        parseMoves(line, size, moves);
+        if (!moves.empty())
+            openings.push_back(moves);
+    }
+    if (openings.empty()) {
+        error = path + ": no openings";
+        return false;
+    }
+    return true;
+}
+
+// Reference values from fishtest's normal approximation for pentanomial
+// results; the zero counts in the second row are regularized to 1e-3 pairs.
+static bool verifyElo()
+{
+    struct Case {
+        uint64_t pairs[5];
+        double elo, margin, llr0_5, llrM3_1;
+    };
+    const Case cases[] = {
+        { { 10, 40, 100, 35, 15 }, 4.343171, 22.547766, 0.069845, 0.161984 },
+        { { 0, 5, 20, 5, 0 }, 0.000000, 36.018289, -0.037247, 0.011920 },
+        { { 1, 20, 300, 30, 2 }, 5.905990, 7.573112, 1.141481, 1.851721 },
+    };
+    bool ok = true;
+    auto check = [&](const string& what, double got, double want) {
+        bool same = fabs(got - want) < 1e-5;
+        ok = ok && same;
+        cout << "  " << left << setw(32) << what << right << fixed << setprecision(6) << setw(12) << got
+             << "  fishtest " << setw(12) << want << (same ? " OK" : " MISMATCH") << endl;
+    };
+
+    check("fromScore(0.75)", elo::fromScore(0.75), 190.848502);
+    check("toScore(fromScore(0.3))", elo::toScore(elo::fromScore(0.3)), 0.3);
+    elo::Sprt sprt;
+    check("SPRT lower bound (0.05, 0.05)", sprt.lower(), -2.944439);
+    check("SPRT upper bound (0.05, 0.05)", sprt.upper(), 2.944439);
+    for (const Case& c : cases) {
+        elo::Pentanomial p;
+        copy(begin(c.pairs), end(c.pairs), p.pairs);
+        string name;
+        for (uint64_t n : c.pairs)
+            name += (name.empty() ? "" : " ") + to_string(n);
+        check(name + ": Elo", p.elo(), c.elo);
+        check(name + ": error margin", p.errorMargin(), c.margin);
+        check(name + ": LLR [0, 5]", p.llr(0, 5), c.llr0_5);
+        check(name + ": LLR [-3, 1]", p.llr(-3, 1), c.llrM3_1);
+    }
+    return ok;
+}
+
+static void printPairing(const Options& opt, const Pairing& p)
+{
+    const string& a = opt.engines[p.a].name;
+    const string& b = opt.engines[p.b].name;
+    cout << "  " << a << " vs " << b << ": " << showpos << fixed << setprecision(1) << p.pairs.elo()
+         << noshowpos << " +/- " << p.pairs.errorMargin() << " Elo, W " << p.wins << " D " << p.draws
+         << " L " << p.losses << " (" << p.pairs.count() << " pairs:";
+    for (uint64_t n : p.pairs.pairs)
+        cout << " " << n;
+    cout << ")" << endl;
+    if (p.timeLosses[0] || p.timeLosses[1])
+        cout << "    lost on time: " << a << " " << p.timeLosses[0] << ", " << b << " " << p.timeLosses[1] << endl;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 2 && string(argv[1]) == "--verify")
+        return verifyElo() ? 0 : 1;
+
+    Options opt;
+    if (!parse(argc, argv, opt)) {
+        usage();
+        return 2;
+    }
+
+    vector<vector<uint8_t>> openings;
+    if (!opt.openingsFile.empty()) {
+        string error;
+        if (!loadOpenings(opt.openingsFile, opt.size, openings, error)) {
+            cerr << error << endl;
+            return 1;
+        }
+        opt.randomPlies = 0;
+    }
+
+    vector<Pairing> pairings;
+    for (int a = 0; a < (int)opt.engines.size(); a++)
+        for (int b = a + 1; b < (int)opt.engines.size(); b++)
+            pairings.push_back({ a, b, {} });
+
+    // Games side by side without asking for more search threads than cores
+    int cores = max(1u, thread::hardware_concurrency());
+    int perGame = 1;
+    for (const EngineSpec& e : opt.engines)
+        perGame = max(perGame, e.config.random ? 1 : e.config.threads);
+    if (opt.concurrency <= 0)
+        opt.concurrency = max(1, cores / perGame);
+    else if (opt.concurrency * perGame > cores && opt.timed)
+        cerr << "warning: " << opt.concurrency * perGame << " search threads on " << cores
+             << " cores, the clocks will not be fair" << endl;
+    opt.games -= opt.games % 2;
+    opt.concurrency = (int)min<uint64_t>(opt.concurrency, max<uint64_t>(1, opt.games));
+
+    GameLog log;
+    string error;
+    if (!opt.out.empty()) {
+        if (!log.open(opt.out, &error)) {
+            cerr << error << endl;
+            return 1;
+        }
+        log.setBatch(1 << 16, 1.0);
+    }
+
+    // Game 2k and 2k + 1 are pair k: pairing k % P, opening k / P, the
+    // pairing's first engine playing X, then O
+    mutex resultLock;
+    condition_variable changed;
+    vector<int> firstHalf(opt.games / 2, -1);   // a's half points in the pair's first game
+    atomic<uint64_t> nextGame{ 0 };
+    atomic<bool> stop{ false };
+    uint64_t played = 0;
+    int running = opt.concurrency;
+    int decision = 0;
+
+    auto work = [&] {
+        AnyBoard board(opt.size);
+        GameRecord game;
+        game.moves.reserve(2 * opt.size * opt.size);
+        vector<unique_ptr<Player>> players(opt.engines.size());
+        Xoshiro256 rng;
+        const vector<uint8_t> noOpening;
+        for (uint64_t g; !stop && (g = nextGame++) < opt.games; ) {
+            uint64_t pair = g / 2, opening = pair / pairings.size();
+            Pairing& p = pairings[pair % pairings.size()];
+            bool aIsX = g % 2 == 0;
+            int xi = aIsX ? p.a : p.b, oi = aIsX ? p.b : p.a;
+            for (int i : { xi, oi })
+                if (!players[i])
+                    players[i] = make_unique<Player>(opt.engines[i].config);
+
+            rng.reseed(opt.seed + opening);
+            const vector<uint8_t>& line = openings.empty() ? noOpening : openings[opening % openings.size()];
+            Disk flagged = playGame(board, *players[xi], *players[oi], line, opt.randomPlies, rng, game,
+                                    opt.timed ? &opt.clock : nullptr);
+
+            // a's points in half points: 2 a win, 1 a draw
+            int diff = game.discs[0] - game.discs[1];
+            if (flagged != Disk::Empty)
+                diff = flagged == Disk::X ? -1 : 1;
+            int forA = diff == 0 ? 1 : (diff > 0) == aIsX ? 2 : 0;
+
+            lock_guard<mutex> hold(resultLock);
+            if (log.isOpen())
+                log.appendGame(game);
+            played++;
+            if (forA == 2) p.wins++;
+            else if (forA == 1) p.draws++;
+            else p.losses++;
+            if (flagged != Disk::Empty)
+                p.timeLosses[(flagged == Disk::X) == aIsX ? 0 : 1]++;
+            if (firstHalf[pair] < 0) {
+                firstHalf[pair] = forA;
+                continue;
+            }
+            p.pairs.add(firstHalf[pair] + forA);
+            if (opt.sprt && !decision && (decision = opt.test.decide(p.pairs)) != 0)
+                stop = true;
+        }
+        lock_guard<mutex> hold(resultLock);
+        running--;
+        changed.notify_one();
+    };
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (int t = 0; t < opt.concurrency; t++)
+        pool.emplace_back(work);
+    bool reported = false;
+    {
+        unique_lock<mutex> wait(resultLock);
+        while (!changed.wait_for(wait, chrono::seconds(1), [&] { return running == 0; })) {
+            const Pairing& p = pairings[0];
+            cerr << "\r" << played << "/" << opt.games << " games, " << opt.engines[p.a].name << " "
+                 << showpos << fixed << setprecision(1) << p.pairs.elo() << noshowpos
+                 << " +/- " << p.pairs.errorMargin();
+            if (opt.sprt)
+                cerr << ", LLR " << setprecision(2) << p.pairs.llr(opt.test.elo0, opt.test.elo1);
+            cerr << "   " << flush;
+            reported = true;
+        }
+    }
+    for (thread& t : pool)
+        t.join();
+    if (reported)
+        cerr << endl;
+    log.close();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "tournament: " << played << " games, " << opt.concurrency << " at a time, "
+         << fixed << setprecision(1) << secs << " s" << endl;
+    for (const Pairing& p : pairings)
+        printPairing(opt, p);
+    if (opt.sprt) {
+        const Pairing& p = pairings[0];
+        cout << "  SPRT [" << opt.test.elo0 << ", " << opt.test.elo1 << "]: LLR " << setprecision(2)
+             << p.pairs.llr(opt.test.elo0, opt.test.elo1) << " (" << opt.test.lower() << ", " << opt.test.upper()
+             << "), " << (decision > 0 ? "H1 accepted" : decision < 0 ? "H0 accepted" : "no decision") << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "tt.hpp"
+
+TranspositionTable::TranspositionTable(size_t megabytes)
+{
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(size_t megabytes)
+{
+    size_t wanted = (megabytes << 20) / sizeof(Bucket);
+    size_t count = 1;
+    while (count * 2 <= wanted)
+        count *= 2;
+
+    buckets.reset(new Bucket[count]);
+    bucketCount = count;
+    clear();
+}
+
+void TranspositionTable::clear()
+{
+    for (size_t i = 0; i < bucketCount; i++) {
+        for (Entry& e : buckets[i].entries) {
+            e.check.store(0, std::memory_order_relaxed);
+            e.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+bool TranspositionTable::probe(uint64_t key, Hit& out) const
+{
+    Bucket& b = bucketFor(key);
+    for (const Entry& e : b.entries) {
+        uint64_t data = e.data.load(std::memory_order_relaxed);
+        uint64_t check = e.check.load(std::memory_order_relaxed);
+        if ((check ^ data) != key || ((data >> 48) & 3) == NONE)
+            continue;
+
+        int move = (int)((data >> 40) & 0xFF);
+        out.score = (int32_t)(uint32_t)data;
+        out.depth = (int)((data >> 32) & 0xFF);
+        out.move = move == 0xFF ? -1 : move;
+        out.bound = (Bound)((data >> 48) & 3);
+        return true;
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, int score, int depth, int move, Bound bound)
+{
+    Bucket& b = bucketFor(key);
+
+    // Same position first, otherwise the shallowest entry, preferring ones
+    // left over from an older search.
+    Entry* victim = &b.entries[0];
+    int victimWorth = 1 << 30;
+    for (Entry& e : b.entries) {
+        uint64_t data = e.data.load(std::memory_order_relaxed);
+        uint64_t check = e.check.load(std::memory_order_relaxed);
+        if ((check ^ data) == key) {
+            // Keep the old best move when the new result has none
+            if (move < 0 && ((data >> 40) & 0xFF) != 0xFF)
+                move = (int)((data >> 40) & 0xFF);
+            victim = &e;
+            break;
+        }
+        int age = (generation - (int)((data >> 50) & GEN_MASK)) & GEN_MASK;
+        int worth = (int)((data >> 32) & 0xFF) - 8 * age;
+        if (((data >> 48) & 3) == NONE)
+            worth = -(1 << 20);
+        if (worth < victimWorth) {
+            victimWorth = worth;
+            victim = &e;
+        }
+    }
+
+    uint64_t data = pack(score, depth, move, bound, generation);
+    victim->data.store(data, std::memory_order_relaxed);
+    victim->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const
+{
+    int used = 0, samples = 0;
+    for (size_t i = 0; i < bucketCount && samples < 1000; i++) {
+        for (const Entry& e : buckets[i].entries) {
+            uint64_t data = e.data.load(std::memory_order_relaxed);
+            if (((data >> 48) & 3) != NONE && ((data >> 50) & GEN_MASK) == generation)
+                used++;
+            samples++;
+        }
+    }
+    return samples ? used * 1000 / samples : 0;
+}
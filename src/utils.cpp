@@ -8,11 +8,8 @@
 
 #ifdef _WIN32
 #include <windows.h>
-#include <conio.h>
 #else
 #include <unistd.h>
-#include <termios.h>
-#include <fcntl.h>
 #endif
 #include <sys/ioctl.h>
 #include <sys/types.h>
@@ -105,51 +102,6 @@ void showCursor() {
 #endif
 }
 
-int getch() {
-#ifdef _WIN32
-    return _getch();
-#else
-    struct termios oldt, newt;
-    int ch;
-    tcgetattr(STDIN_FILENO, &oldt);
-    newt = oldt;
-    newt.c_lflag &= ~(ICANON | ECHO);
-    tcsetattr(STDIN_FILENO, TCSANOW, &newt);
-    ch = getchar();
-    tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
-    return ch;
-#endif
-}
-
-bool kbhit() {
-#ifdef _WIN32
-    return _kbhit();
-#else
-    termios oldt, newt;
-    int ch;
-    int oldf;
-
-    tcgetattr(STDIN_FILENO, &oldt);
-    newt = oldt;
-    newt.c_lflag &= ~(ICANON | ECHO);
-    tcsetattr(STDIN_FILENO, TCSANOW, &newt);
-    oldf = fcntl(STDIN_FILENO, F_GETFL, 0);
-    fcntl(STDIN_FILENO, F_SETFL, oldf | O_NONBLOCK);
-
-    ch = getchar();
-
-    tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
-    fcntl(STDIN_FILENO, F_SETFL, oldf);
-
-    if (ch != EOF) {
-        ungetc(ch, stdin);
-        return true;
-    }
-
-    return false;
-#endif
-}
-
 void terminal_size(int width, int height) {
 #ifdef _WIN32
     string cmd = "mode con: cols=" + to_string(width) + " lines=" + to_string(height);
@@ -160,14 +112,6 @@ void terminal_size(int width, int height) {
 #endif
 }
 
-void sleep_ms(int ms) {
-#ifdef _WIN32
-    Sleep(ms);
-#else
-    usleep(ms * 1000);
-#endif
-}
-
 int random_range(int min, int max) {
     return rand() % (max - min + 1) + min;
 }
@@ -0,0 +1,65 @@
+#include "wide_bitboard.hpp"
+#include "wide_kernels.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace widebits {
+
+Bits128 moves10Scalar(const Bits128& own, const Bits128& opp)
+{
+    return WideKernel<ScalarOps<2>, 10>::moves(own, opp);
+}
+
+Bits128 flips10Scalar(int sq, const Bits128& own, const Bits128& opp)
+{
+    return WideKernel<ScalarOps<2>, 10>::flips(sq, own, opp);
+}
+
+Bits256 moves12Scalar(const Bits256& own, const Bits256& opp)
+{
+    return WideKernel<ScalarOps<4>, 12>::moves(own, opp);
+}
+
+Bits256 flips12Scalar(int sq, const Bits256& own, const Bits256& opp)
+{
+    return WideKernel<ScalarOps<4>, 12>::flips(sq, own, opp);
+}
+
+static Kernels<Bits128> pick10(bool scalar)
+{
+#ifdef OTHELLO_HAVE_SSE2
+    if (!scalar && __builtin_cpu_supports("sse2"))
+        return { moves10Sse2, flips10Sse2, "sse2" };
+#endif
+    (void)scalar;
+    return { moves10Scalar, flips10Scalar, "scalar" };
+}
+
+static Kernels<Bits256> pick12(bool scalar)
+{
+#ifdef OTHELLO_HAVE_AVX2
+    if (!scalar && __builtin_cpu_supports("avx2"))
+        return { moves12Avx2, flips12Avx2, "avx2" };
+#endif
+    (void)scalar;
+    return { moves12Scalar, flips12Scalar, "scalar" };
+}
+
+// OTHELLO_SIMD=scalar in the environment starts with the portable kernels.
+static bool scalarRequested()
+{
+    const char* env = std::getenv("OTHELLO_SIMD");
+    return env && std::strcmp(env, "scalar") == 0;
+}
+
+Kernels<Bits128> kernels10 = pick10(scalarRequested());
+Kernels<Bits256> kernels12 = pick12(scalarRequested());
+
+void useScalarKernels(bool scalar)
+{
+    kernels10 = pick10(scalar);
+    kernels12 = pick12(scalar);
+}
+
+} // namespace widebits
@@ -0,0 +1,88 @@
+// 12x12 kernels on 256-bit AVX2 registers. This file is compiled with -mavx2 and
+// is only called after a runtime CPU check (see wide_bitboard.cpp).
+#include "wide_bitboard.hpp"
+
+#ifdef OTHELLO_HAVE_AVX2
+
+#include "wide_kernels.hpp"
+
+#include <immintrin.h>
+
+namespace {
+
+struct Avx2Ops {
+    static constexpr int WORDS = 4;
+    using V = __m256i;
+
+    static V load(const uint64_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(uint64_t* p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static V and_(V a, V b) { return _mm256_and_si256(a, b); }
+    static V or_(V a, V b) { return _mm256_or_si256(a, b); }
+    static V andnot(V a, V b) { return _mm256_andnot_si256(a, b); }
+    static bool testz(V a) { return _mm256_testz_si256(a, a); }
+
+    // Move whole 64-bit lanes up (towards w[3]) or down by Q, filling with zeros.
+    template <int Q>
+    static V lanesUp(V a)
+    {
+        if constexpr (Q == 0) return a;
+        else if constexpr (Q >= 4) return _mm256_setzero_si256();
+        else {
+            constexpr int sel = (Q == 1) ? _MM_SHUFFLE(2, 1, 0, 0)
+                              : (Q == 2) ? _MM_SHUFFLE(1, 0, 0, 0)
+                                         : _MM_SHUFFLE(0, 0, 0, 0);
+            return _mm256_blend_epi32(_mm256_permute4x64_epi64(a, sel), _mm256_setzero_si256(), (1 << (2 * Q)) - 1);
+        }
+    }
+
+    template <int Q>
+    static V lanesDown(V a)
+    {
+        if constexpr (Q == 0) return a;
+        else if constexpr (Q >= 4) return _mm256_setzero_si256();
+        else {
+            constexpr int sel = (Q == 1) ? _MM_SHUFFLE(3, 3, 2, 1)
+                              : (Q == 2) ? _MM_SHUFFLE(3, 3, 3, 2)
+                                         : _MM_SHUFFLE(3, 3, 3, 3);
+            return _mm256_blend_epi32(_mm256_permute4x64_epi64(a, sel), _mm256_setzero_si256(), 0xFF & ~((1 << (8 - 2 * Q)) - 1));
+        }
+    }
+
+    template <int K>
+    static V shl(V a)
+    {
+        constexpr int q = K / 64, r = K % 64;
+        if constexpr (r == 0)
+            return lanesUp<q>(a);
+        else
+            return _mm256_or_si256(_mm256_slli_epi64(lanesUp<q>(a), r), _mm256_srli_epi64(lanesUp<q + 1>(a), 64 - r));
+    }
+
+    template <int K>
+    static V shr(V a)
+    {
+        constexpr int q = K / 64, r = K % 64;
+        if constexpr (r == 0)
+            return lanesDown<q>(a);
+        else
+            return _mm256_or_si256(_mm256_srli_epi64(lanesDown<q>(a), r), _mm256_slli_epi64(lanesDown<q + 1>(a), 64 - r));
+    }
+};
+
+} // namespace
+
+namespace widebits {
+
+Bits256 moves12Avx2(const Bits256& own, const Bits256& opp)
+{
+    return WideKernel<Avx2Ops, 12>::moves(own, opp);
+}
+
+Bits256 flips12Avx2(int sq, const Bits256& own, const Bits256& opp)
+{
+    return WideKernel<Avx2Ops, 12>::flips(sq, own, opp);
+}
+
+} // namespace widebits
+
+#endif
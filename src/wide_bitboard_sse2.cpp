@@ -0,0 +1,60 @@
+// 10x10 kernels on 128-bit SSE2 registers. Built only when the compiler can target SSE2.
+#include "wide_bitboard.hpp"
+
+#ifdef OTHELLO_HAVE_SSE2
+
+#include "wide_kernels.hpp"
+
+#include <emmintrin.h>
+
+namespace {
+
+struct Sse2Ops {
+    static constexpr int WORDS = 2;
+    using V = __m128i;
+
+    static V load(const uint64_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(uint64_t* p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static V and_(V a, V b) { return _mm_and_si128(a, b); }
+    static V or_(V a, V b) { return _mm_or_si128(a, b); }
+    static V andnot(V a, V b) { return _mm_andnot_si128(a, b); }
+    static bool testz(V a) { return _mm_movemask_epi8(_mm_cmpeq_epi8(a, _mm_setzero_si128())) == 0xFFFF; }
+
+    // Whole-register shifts: shift each 64-bit lane, then carry the bits that
+    // crossed the lane boundary over from the other lane.
+    template <int K>
+    static V shl(V a)
+    {
+        if constexpr (K >= 64)
+            return _mm_slli_epi64(_mm_slli_si128(a, 8), K - 64);
+        else
+            return _mm_or_si128(_mm_slli_epi64(a, K), _mm_srli_epi64(_mm_slli_si128(a, 8), 64 - K));
+    }
+
+    template <int K>
+    static V shr(V a)
+    {
+        if constexpr (K >= 64)
+            return _mm_srli_epi64(_mm_srli_si128(a, 8), K - 64);
+        else
+            return _mm_or_si128(_mm_srli_epi64(a, K), _mm_slli_epi64(_mm_srli_si128(a, 8), 64 - K));
+    }
+};
+
+} // namespace
+
+namespace widebits {
+
+Bits128 moves10Sse2(const Bits128& own, const Bits128& opp)
+{
+    return WideKernel<Sse2Ops, 10>::moves(own, opp);
+}
+
+Bits128 flips10Sse2(int sq, const Bits128& own, const Bits128& opp)
+{
+    return WideKernel<Sse2Ops, 10>::flips(sq, own, opp);
+}
+
+} // namespace widebits
+
+#endif